@@ -0,0 +1,49 @@
+// Host runner of the decoder benchmark, same corpora and JSON lines as the CONFIG_RF_BENCH boot run
+#include <stdlib.h>
+#include <time.h>
+#include "rf_common.h"
+#include "rf_bench.h"
+
+static uint64_t bench_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+    static uint32_t trace[256 * 4 * RF_MAX_PULSES];
+    const int codes = argc > 1 ? atoi(argv[1]) : 24;
+    if (codes <= 0 || codes > 256) {
+        fprintf(stderr, "usage: %s [codes per protocol, 1 to 256]\n", argv[0]);
+        return 2;
+    }
+
+    for (int stream = 0; stream < 2; stream++) {
+        for (int corpus = 0; corpus < RF_BENCH_CORPUS_COUNT; corpus++) {
+            const RFBenchConfig config = {
+                .protos = rf_protos(),
+                .proto_count = rf_proto_count(),
+                .tolerance = RECV_TOLERANCE,
+                .separation_limit = SEPARATION_LIMIT,
+                .stream = stream,
+                .codes_per_proto = codes,
+                .repeat = 4,
+                .jitter = 5,
+                .glitch_rate = 20,
+                .drop_rate = 10,
+                .noise_edges = 8000,
+                .seed = 1,
+                .trace = trace,
+                .trace_len = sizeof(trace) / sizeof(trace[0]),
+                .clock = bench_clock,
+            };
+            RFBenchResult result;
+            if (!rf_bench_run(&config, corpus, &result)) {
+                fprintf(stderr, "Bench trace buffer too small\n");
+                return 1;
+            }
+            rf_bench_print(&result, stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "driver/gpio.h"
+
+typedef struct gpio_glitch_filter_t* gpio_glitch_filter_handle_t;
+typedef int glitch_filter_clock_source_t;
+#define GLITCH_FILTER_CLK_SRC_DEFAULT 0
+
+typedef struct {
+    glitch_filter_clock_source_t clk_src;
+    gpio_num_t gpio_num;
+} gpio_pin_glitch_filter_config_t;
+
+typedef struct {
+    glitch_filter_clock_source_t clk_src;
+    gpio_num_t gpio_num;
+    uint32_t window_width_ns;
+    uint32_t window_thres_ns;
+} gpio_flex_glitch_filter_config_t;
+
+// The host pins have no glitch filters, creation reports them as unsupported
+esp_err_t gpio_new_pin_glitch_filter(const gpio_pin_glitch_filter_config_t* config, gpio_glitch_filter_handle_t* ret_filter);
+esp_err_t gpio_new_flex_glitch_filter(const gpio_flex_glitch_filter_config_t* config, gpio_glitch_filter_handle_t* ret_filter);
+esp_err_t gpio_glitch_filter_enable(gpio_glitch_filter_handle_t filter);
+esp_err_t gpio_glitch_filter_disable(gpio_glitch_filter_handle_t filter);
+esp_err_t gpio_del_glitch_filter(gpio_glitch_filter_handle_t filter);
@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+// Nanoseconds of the host's monotonic clock
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+static inline int esp_cpu_get_core_id(void) {
+    return 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <stddef.h>
+
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+void* heap_caps_malloc(size_t size, unsigned caps);
+void* heap_caps_calloc(size_t n, size_t size, unsigned caps);
+void heap_caps_free(void* ptr);
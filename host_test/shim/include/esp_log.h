@@ -0,0 +1,13 @@
+#pragma once
+#include <stdio.h>
+
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG } esp_log_level_t;
+
+// Messages above the level set with shim_log_level (errors by default) are dropped
+void shim_log(esp_log_level_t level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, format, ...) shim_log(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) shim_log(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) shim_log(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) shim_log(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_DRAM_LOGE(tag, format, ...) shim_log(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
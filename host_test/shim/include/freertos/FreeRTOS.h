@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_attr.h"
+#include "sdkconfig.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS (1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(x) ((TickType_t)((uint64_t)(x) * CONFIG_FREERTOS_HZ / 1000))
+#define pdTICKS_TO_MS(x) ((uint32_t)((uint64_t)(x) * 1000 / CONFIG_FREERTOS_HZ))
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY 0x7fffffff
+
+// All critical sections share one recursive host mutex, interrupts and tasks both take it
+typedef struct {
+    int owner;
+    int count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portMUX_INITIALIZE(m) ((m)->owner = 0, (m)->count = 0)
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m) vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m) vPortExitCritical(m)
+#define portENTER_CRITICAL_SAFE(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_SAFE(m) vPortExitCritical(m)
+#define portYIELD_FROM_ISR(...) do {} while (0)
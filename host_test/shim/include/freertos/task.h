@@ -0,0 +1,24 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+typedef struct {
+    int64_t start_us;
+} TimeOut_t;
+
+#define tskIDLE_PRIORITY 0
+
+// Tasks are host threads, delays and timeouts run on the wall clock
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* ret_task);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* ret_task, BaseType_t core_id);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+void vTaskSetTimeOutState(TimeOut_t* timeout);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* timeout, TickType_t* ticks_left);
@@ -0,0 +1,2 @@
+#pragma once
+#define CONFIG_FREERTOS_HZ 1000
@@ -0,0 +1,49 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/rmt_types.h"
+
+/* Test control side of the host shims. Time is virtual: esp_timer_get_time and the GPTimer
+counters only move when a test advances them, so interrupt driven code runs deterministically */
+
+// Puts the clock back to zero and every pin back to its reset state
+void shim_reset(void);
+void shim_log_level(esp_log_level_t level);
+
+// Moving the clock forward runs the esp_timer callbacks that fall due on the way, in order
+void shim_advance(int64_t us);
+void shim_advance_to(int64_t time);
+
+typedef struct {
+    int64_t time;
+    int8_t gpio;
+    uint8_t level;
+} ShimGpioEvent;
+
+// Every level change on an output pin, in the order it happened
+void shim_gpio_trace_reset(void);
+size_t shim_gpio_trace(const ShimGpioEvent** events);
+size_t shim_gpio_trace_pin(gpio_num_t gpio, int64_t* times, uint8_t* levels, size_t max);
+
+// Connects an output pin to another pin, which follows its level from then on (GPIO_NUM_NC cuts it)
+void shim_gpio_wire(gpio_num_t from, gpio_num_t to);
+
+// Drives a pin from outside the chip and runs its edge interrupt when one is armed
+void shim_gpio_input(gpio_num_t gpio, int level);
+
+/* Fires GPTimer alarms in time order until none is armed or the next one lies past until.
+The latency callback, when given, delays each interrupt by the returned microseconds before the
+callback runs, like a busy CPU would. Returns the number of alarms fired */
+typedef uint32_t (*ShimLatency)(void* ctx);
+size_t shim_gptimer_run(int64_t until, ShimLatency latency, void* ctx);
+
+// Completes the oldest pending transmission on an RMT TX channel
+bool shim_rmt_tx_complete(rmt_channel_handle_t channel);
+size_t shim_rmt_tx_symbols(rmt_channel_handle_t channel, const rmt_symbol_word_t** symbols);
+int shim_rmt_tx_loop_count(rmt_channel_handle_t channel);
+
+// Copies symbols into the pending receive buffer and runs the receive done callback
+bool shim_rmt_rx_feed(rmt_channel_handle_t channel, const rmt_symbol_word_t* symbols, size_t count, bool is_last);
+bool shim_rmt_rx_pending(rmt_channel_handle_t channel);
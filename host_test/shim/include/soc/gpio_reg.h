@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+#include "soc/soc_caps.h"
+
+// Only the output set/clear registers exist, writes to them drive the shim pins like gpio_set_level does
+#define GPIO_OUT_W1TS_REG 0x60091008
+#define GPIO_OUT_W1TC_REG 0x6009100C
+#define GPIO_OUT1_W1TS_REG 0x60091014
+#define GPIO_OUT1_W1TC_REG 0x60091018
+
+void shim_reg_write(uint32_t reg, uint32_t value);
+
+#define REG_WRITE(reg, val) shim_reg_write((reg), (val))
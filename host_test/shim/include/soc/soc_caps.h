@@ -0,0 +1,7 @@
+#pragma once
+#define SOC_CPU_CORES_NUM 2
+#define SOC_GPIO_PIN_COUNT 49
+#define SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER 1
+#define SOC_RMT_SUPPORT_DMA 1
+#define SOC_RMT_SUPPORT_TX_LOOP_COUNT 1
+#define SOC_RMT_SUPPORT_RX_PINGPONG 1
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "shim.h"
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    int64_t expiry;
+    uint64_t period;
+    bool active;
+    struct esp_timer* next;
+};
+
+static int64_t shim_now;
+static struct esp_timer* timers;
+
+int64_t esp_timer_get_time(void) {
+    return __atomic_load_n(&shim_now, __ATOMIC_ACQUIRE);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+    struct esp_timer* timer = calloc(1, sizeof(struct esp_timer));
+    if (!timer) return ESP_ERR_NO_MEM;
+    timer->args = *args;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    portENTER_CRITICAL(&lock);
+    timer->next = timers;
+    timers = timer;
+    portEXIT_CRITICAL(&lock);
+    *out = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->expiry = esp_timer_get_time() + (int64_t)timeout_us;
+    timer->period = period;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    if (period_us == 0) return ESP_ERR_INVALID_ARG;
+    return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    portENTER_CRITICAL(&lock);
+    for (struct esp_timer** link = &timers; *link; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->active;
+}
+
+void shim_advance_to(int64_t time) {
+    while (1) {
+        struct esp_timer* due = NULL;
+        for (struct esp_timer* timer = timers; timer; timer = timer->next) {
+            if (timer->active && timer->expiry <= time && (!due || timer->expiry < due->expiry))
+                due = timer;
+        }
+        if (!due) break;
+
+        if (due->expiry > shim_now) __atomic_store_n(&shim_now, due->expiry, __ATOMIC_RELEASE);
+        if (due->period) due->expiry += (int64_t)due->period;
+        else due->active = false;
+        due->args.callback(due->args.arg);
+    }
+    if (time > shim_now) __atomic_store_n(&shim_now, time, __ATOMIC_RELEASE);
+}
+
+void shim_advance(int64_t us) {
+    shim_advance_to(esp_timer_get_time() + us);
+}
+
+void shim_clock_reset(void) {
+    __atomic_store_n(&shim_now, 0, __ATOMIC_RELEASE);
+    for (struct esp_timer* timer = timers; timer; timer = timer->next)
+        timer->active = false;
+}
@@ -0,0 +1,254 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+// Blocked tasks wake at least this often to notice vTaskDelete from another task
+#define SHIM_WAIT_SLICE_MS 10
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* arg;
+    bool own_thread;
+    bool deleted;
+    uint32_t notify;
+    pthread_cond_t notify_cond;
+};
+
+struct QueueDefinition {
+    uint8_t* items;
+    UBaseType_t item_size;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+    pthread_cond_t cond;
+};
+
+static pthread_mutex_t critical;
+static pthread_mutex_t kernel = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+static __thread struct tskTaskControlBlock* current_task;
+
+static void critical_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    pthread_once(&critical_once, critical_init);
+    pthread_mutex_lock(&critical);
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    pthread_mutex_unlock(&critical);
+}
+
+static int64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static struct tskTaskControlBlock* task_self(void) {
+    if (!current_task) {
+        current_task = calloc(1, sizeof(struct tskTaskControlBlock));
+        if (!current_task) abort();
+        current_task->thread = pthread_self();
+        pthread_cond_init(&current_task->notify_cond, NULL);
+    }
+    return current_task;
+}
+
+// Waits on cond under the kernel lock, false once the deadline passes
+static bool task_wait(pthread_cond_t* cond, int64_t deadline) {
+    struct tskTaskControlBlock* self = task_self();
+    if (self->deleted) {
+        pthread_mutex_unlock(&kernel);
+        pthread_exit(NULL);
+    }
+    const int64_t now = wall_ms();
+    if (deadline >= 0 && now >= deadline) return false;
+
+    int64_t wake = now + SHIM_WAIT_SLICE_MS;
+    if (deadline >= 0 && deadline < wake) wake = deadline;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const int64_t ns = ts.tv_nsec + (wake - now) * 1000000;
+    ts.tv_sec += ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    pthread_cond_timedwait(cond, &kernel, &ts);
+    return true;
+}
+
+static int64_t task_deadline(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? -1 : wall_ms() + pdTICKS_TO_MS(ticks);
+}
+
+static void* task_entry(void* arg) {
+    current_task = arg;
+    current_task->fn(current_task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* ret_task, BaseType_t core_id) {
+    struct tskTaskControlBlock* task = calloc(1, sizeof(struct tskTaskControlBlock));
+    if (!task) return pdFAIL;
+    task->fn = fn;
+    task->arg = arg;
+    task->own_thread = true;
+    pthread_cond_init(&task->notify_cond, NULL);
+    if (ret_task) *ret_task = task;
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* ret_task) {
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, ret_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == current_task) {
+        pthread_detach(pthread_self());
+        pthread_exit(NULL);
+    }
+    pthread_mutex_lock(&kernel);
+    task->deleted = true;
+    pthread_mutex_unlock(&kernel);
+    // The task leaves at its next blocking call
+    pthread_join(task->thread, NULL);
+    pthread_cond_destroy(&task->notify_cond);
+    free(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    const int64_t deadline = wall_ms() + pdTICKS_TO_MS(ticks);
+    pthread_mutex_lock(&kernel);
+    while (task_wait(&cond, deadline)) {}
+    pthread_mutex_unlock(&kernel);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return pdMS_TO_TICKS(wall_ms());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return task_self();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct tskTaskControlBlock* self = task_self();
+    const int64_t deadline = task_deadline(ticks);
+    pthread_mutex_lock(&kernel);
+    while (!self->notify && task_wait(&self->notify_cond, deadline)) {}
+    const uint32_t value = self->notify;
+    if (value) self->notify = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&kernel);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&kernel);
+    task->notify++;
+    pthread_cond_broadcast(&task->notify_cond);
+    pthread_mutex_unlock(&kernel);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+void vTaskSetTimeOutState(TimeOut_t* timeout) {
+    timeout->start_us = wall_ms() * 1000;
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* timeout, TickType_t* ticks_left) {
+    if (*ticks_left == portMAX_DELAY) return pdFALSE;
+    const int64_t now = wall_ms() * 1000;
+    const TickType_t elapsed = pdMS_TO_TICKS((now - timeout->start_us) / 1000);
+    if (elapsed >= *ticks_left) {
+        *ticks_left = 0;
+        return pdTRUE;
+    }
+    *ticks_left -= elapsed;
+    timeout->start_us = now;
+    return pdFALSE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct QueueDefinition* queue = calloc(1, sizeof(struct QueueDefinition));
+    if (!queue) return NULL;
+    queue->items = calloc(length ? length : 1, item_size ? item_size : 1);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    pthread_cond_init(&queue->cond, NULL);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (!queue) return;
+    pthread_cond_destroy(&queue->cond);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    const int64_t deadline = task_deadline(ticks);
+    pthread_mutex_lock(&kernel);
+    while (queue->count == queue->length && task_wait(&queue->cond, deadline)) {}
+    if (queue->count == queue->length) {
+        pthread_mutex_unlock(&kernel);
+        return pdFAIL;
+    }
+    memcpy(queue->items + ((queue->head + queue->count) % queue->length) * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&kernel);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    const BaseType_t ret = xQueueSend(queue, item, 0);
+    if (ret == pdPASS && woken) *woken = pdTRUE;
+    return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    const int64_t deadline = task_deadline(ticks);
+    pthread_mutex_lock(&kernel);
+    while (queue->count == 0 && task_wait(&queue->cond, deadline)) {}
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&kernel);
+        return pdFAIL;
+    }
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&kernel);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&kernel);
+    const UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&kernel);
+    return count;
+}
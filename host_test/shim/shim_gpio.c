@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "driver/gpio_filter.h"
+#include "esp_timer.h"
+#include "soc/gpio_reg.h"
+#include "shim.h"
+#include "shim_internal.h"
+
+typedef struct {
+    gpio_mode_t mode;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    uint8_t level;
+    gpio_isr_t handler;
+    void* arg;
+} ShimPin;
+
+static ShimPin pins[GPIO_NUM_MAX];
+static int8_t wires[GPIO_NUM_MAX];  // Target pin + 1, 0 when not wired
+static bool isr_service;
+static ShimGpioEvent* trace;
+static size_t trace_len;
+static size_t trace_cap;
+
+static bool pin_valid(gpio_num_t gpio) {
+    return gpio >= 0 && gpio < GPIO_NUM_MAX;
+}
+
+static void trace_push(gpio_num_t gpio, uint8_t level) {
+    if (trace_len == trace_cap) {
+        trace_cap = trace_cap ? trace_cap * 2 : 1024;
+        trace = realloc(trace, trace_cap * sizeof(ShimGpioEvent));
+        if (!trace) abort();
+    }
+    trace[trace_len++] = (ShimGpioEvent){ .time = esp_timer_get_time(), .gpio = gpio, .level = level };
+}
+
+static void pin_drive(gpio_num_t gpio, uint8_t level) {
+    ShimPin* pin = &pins[gpio];
+    if (pin->level == level) return;
+    pin->level = level;
+    if (pin->mode & GPIO_MODE_OUTPUT) trace_push(gpio, level);
+
+    const bool fire = pin->intr_type == GPIO_INTR_ANYEDGE
+        || (pin->intr_type == GPIO_INTR_POSEDGE && level)
+        || (pin->intr_type == GPIO_INTR_NEGEDGE && !level);
+    if ((pin->mode & GPIO_MODE_INPUT) && pin->intr_enabled && pin->handler && fire) pin->handler(pin->arg);
+
+    if (wires[gpio] && wires[gpio] - 1 != gpio) pin_drive(wires[gpio] - 1, level);
+}
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    if (!config || (config->pin_bit_mask >> GPIO_NUM_MAX)) return ESP_ERR_INVALID_ARG;
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (!(config->pin_bit_mask & (1ULL << i))) continue;
+        pins[i].mode = config->mode;
+        pins[i].intr_type = config->intr_type;
+        pins[i].intr_enabled = config->intr_type != GPIO_INTR_DISABLE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].mode = GPIO_MODE_DISABLE;
+    pins[gpio].intr_type = GPIO_INTR_DISABLE;
+    pins[gpio].intr_enabled = false;
+    pins[gpio].level = 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    if (pins[gpio].mode & GPIO_MODE_OUTPUT) pin_drive(gpio, level ? 1 : 0);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio) {
+    return pin_valid(gpio) ? pins[gpio].level : 0;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t intr_type) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags) {
+    if (isr_service) return ESP_ERR_INVALID_STATE;
+    isr_service = true;
+    return ESP_OK;
+}
+
+void gpio_uninstall_isr_service(void) {
+    isr_service = false;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t handler, void* arg) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    if (!isr_service) return ESP_ERR_INVALID_STATE;
+    pins[gpio].handler = handler;
+    pins[gpio].arg = arg;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].handler = NULL;
+    pins[gpio].arg = NULL;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio) {
+    if (!pin_valid(gpio)) return ESP_ERR_INVALID_ARG;
+    pins[gpio].intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_new_pin_glitch_filter(const gpio_pin_glitch_filter_config_t* config, gpio_glitch_filter_handle_t* ret_filter) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t gpio_new_flex_glitch_filter(const gpio_flex_glitch_filter_config_t* config, gpio_glitch_filter_handle_t* ret_filter) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t gpio_glitch_filter_enable(gpio_glitch_filter_handle_t filter) {
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_glitch_filter_disable(gpio_glitch_filter_handle_t filter) {
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_del_glitch_filter(gpio_glitch_filter_handle_t filter) {
+    return ESP_ERR_INVALID_ARG;
+}
+
+void shim_gpio_write_mask(uint64_t set_mask, uint64_t clear_mask) {
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (!(pins[i].mode & GPIO_MODE_OUTPUT)) continue;
+        if (set_mask & (1ULL << i)) pin_drive(i, 1);
+        else if (clear_mask & (1ULL << i)) pin_drive(i, 0);
+    }
+}
+
+void shim_reg_write(uint32_t reg, uint32_t value) {
+    switch (reg) {
+        case GPIO_OUT_W1TS_REG: shim_gpio_write_mask(value, 0); break;
+        case GPIO_OUT_W1TC_REG: shim_gpio_write_mask(0, value); break;
+        case GPIO_OUT1_W1TS_REG: shim_gpio_write_mask((uint64_t)value << 32, 0); break;
+        case GPIO_OUT1_W1TC_REG: shim_gpio_write_mask(0, (uint64_t)value << 32); break;
+        default: abort();
+    }
+}
+
+void shim_gpio_wire(gpio_num_t from, gpio_num_t to) {
+    if (pin_valid(from)) wires[from] = pin_valid(to) ? to + 1 : 0;
+}
+
+void shim_gpio_input(gpio_num_t gpio, int level) {
+    if (pin_valid(gpio)) pin_drive(gpio, level ? 1 : 0);
+}
+
+void shim_gpio_trace_reset(void) {
+    trace_len = 0;
+}
+
+size_t shim_gpio_trace(const ShimGpioEvent** events) {
+    *events = trace;
+    return trace_len;
+}
+
+size_t shim_gpio_trace_pin(gpio_num_t gpio, int64_t* times, uint8_t* levels, size_t max) {
+    size_t count = 0;
+    for (size_t i = 0; i < trace_len && count < max; i++) {
+        if (trace[i].gpio != gpio) continue;
+        if (times) times[count] = trace[i].time;
+        if (levels) levels[count] = trace[i].level;
+        count++;
+    }
+    return count;
+}
+
+void shim_gpio_reset(void) {
+    memset(pins, 0, sizeof(pins));
+    memset(wires, 0, sizeof(wires));
+    isr_service = false;
+    trace_len = 0;
+}
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include "driver/gptimer.h"
+#include "esp_timer.h"
+#include "shim.h"
+
+struct gptimer_t {
+    uint32_t resolution_hz;
+    bool enabled;
+    bool running;
+    uint64_t base_count;
+    int64_t base_time;
+    bool armed;
+    gptimer_alarm_config_t alarm;
+    gptimer_alarm_cb_t on_alarm;
+    void* user_data;
+    struct gptimer_t* next;
+};
+
+static struct gptimer_t* gptimers;
+
+static uint64_t timer_count(const struct gptimer_t* timer, int64_t now) {
+    if (!timer->running) return timer->base_count;
+    return timer->base_count + (uint64_t)(now - timer->base_time) * timer->resolution_hz / 1000000;
+}
+
+static void timer_rebase(struct gptimer_t* timer, uint64_t count) {
+    timer->base_count = count;
+    timer->base_time = esp_timer_get_time();
+}
+
+// First microsecond at which the counter has reached the alarm
+static int64_t timer_due(const struct gptimer_t* timer) {
+    const uint64_t count = timer_count(timer, esp_timer_get_time());
+    if (timer->alarm.alarm_count <= count) return esp_timer_get_time();
+    const uint64_t ticks = timer->alarm.alarm_count - timer->base_count;
+    return timer->base_time + (int64_t)((ticks * 1000000 + timer->resolution_hz - 1) / timer->resolution_hz);
+}
+
+esp_err_t gptimer_new_timer(const gptimer_config_t* config, gptimer_handle_t* ret_timer) {
+    if (!config || !ret_timer || config->resolution_hz == 0 || config->direction != GPTIMER_COUNT_UP)
+        return ESP_ERR_INVALID_ARG;
+    struct gptimer_t* timer = calloc(1, sizeof(struct gptimer_t));
+    if (!timer) return ESP_ERR_NO_MEM;
+    timer->resolution_hz = config->resolution_hz;
+    timer->next = gptimers;
+    gptimers = timer;
+    *ret_timer = timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_del_timer(gptimer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->enabled) return ESP_ERR_INVALID_STATE;
+    for (struct gptimer_t** link = &gptimers; *link; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t* cbs, void* user_data) {
+    if (!timer || !cbs) return ESP_ERR_INVALID_ARG;
+    if (timer->enabled) return ESP_ERR_INVALID_STATE;
+    timer->on_alarm = cbs->on_alarm;
+    timer->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->enabled) return ESP_ERR_INVALID_STATE;
+    timer->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_disable(gptimer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->enabled || timer->running) return ESP_ERR_INVALID_STATE;
+    timer->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->enabled || timer->running) return ESP_ERR_INVALID_STATE;
+    timer_rebase(timer, timer->base_count);
+    timer->running = true;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->running) return ESP_ERR_INVALID_STATE;
+    timer_rebase(timer, timer_count(timer, esp_timer_get_time()));
+    timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_raw_count(gptimer_handle_t timer, uint64_t value) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    timer_rebase(timer, value);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t* value) {
+    if (!timer || !value) return ESP_ERR_INVALID_ARG;
+    *value = timer_count(timer, esp_timer_get_time());
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t* config) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    timer->armed = config != NULL;
+    if (config) timer->alarm = *config;
+    return ESP_OK;
+}
+
+size_t shim_gptimer_run(int64_t until, ShimLatency latency, void* ctx) {
+    size_t fired = 0;
+    while (1) {
+        struct gptimer_t* next = NULL;
+        int64_t next_due = 0;
+        for (struct gptimer_t* timer = gptimers; timer; timer = timer->next) {
+            if (!timer->running || !timer->armed || !timer->on_alarm) continue;
+            const int64_t due = timer_due(timer);
+            if (!next || due < next_due) {
+                next = timer;
+                next_due = due;
+            }
+        }
+        if (!next || next_due > until) break;
+
+        shim_advance_to(next_due);
+        // The counter reloads in hardware at the alarm, only the interrupt is late
+        if (next->alarm.flags.auto_reload_on_alarm) timer_rebase(next, next->alarm.reload_count);
+        else next->armed = false;
+        if (latency) shim_advance(latency(ctx));
+
+        const gptimer_alarm_event_data_t edata = {
+            .count_value = timer_count(next, esp_timer_get_time()),
+            .alarm_value = next->alarm.alarm_count,
+        };
+        next->on_alarm(next, &edata, next->user_data);
+        fired++;
+    }
+    if (until != INT64_MAX) shim_advance_to(until);
+    return fired;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <stdint.h>
+
+void shim_clock_reset(void);
+void shim_gpio_reset(void);
+void shim_gpio_write_mask(uint64_t set_mask, uint64_t clear_mask);
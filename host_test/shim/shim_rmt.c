@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <string.h>
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "shim.h"
+#include "soc/soc_caps.h"
+
+#define SHIM_RMT_TX_QUEUE 16
+
+typedef struct {
+    rmt_symbol_word_t* symbols;
+    size_t count;
+    int loop_count;
+} ShimRmtTrans;
+
+struct rmt_channel_t {
+    bool tx;
+    bool enabled;
+    size_t queue_depth;
+    ShimRmtTrans trans[SHIM_RMT_TX_QUEUE];
+    size_t trans_head;
+    size_t trans_count;
+    ShimRmtTrans last;
+    rmt_tx_done_callback_t on_trans_done;
+    rmt_rx_done_callback_t on_recv_done;
+    void* user_data;
+    rmt_symbol_word_t* rx_buffer;
+    size_t rx_size;
+};
+
+struct rmt_encoder_t {
+    int dummy;
+};
+
+static esp_err_t channel_new(bool tx, size_t queue_depth, rmt_channel_handle_t* ret_chan) {
+    if (!ret_chan) return ESP_ERR_INVALID_ARG;
+    struct rmt_channel_t* chan = calloc(1, sizeof(struct rmt_channel_t));
+    if (!chan) return ESP_ERR_NO_MEM;
+    chan->tx = tx;
+    chan->queue_depth = queue_depth && queue_depth < SHIM_RMT_TX_QUEUE ? queue_depth : SHIM_RMT_TX_QUEUE;
+    *ret_chan = chan;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t* config, rmt_channel_handle_t* ret_chan) {
+    if (!config) return ESP_ERR_INVALID_ARG;
+    return channel_new(true, config->trans_queue_depth, ret_chan);
+}
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t* config, rmt_channel_handle_t* ret_chan) {
+    if (!config || config->gpio_num < 0 || config->gpio_num >= SOC_GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+    return channel_new(false, 0, ret_chan);
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    if (channel->enabled) return ESP_ERR_INVALID_STATE;
+    for (size_t i = 0; i < channel->trans_count; i++)
+        free(channel->trans[(channel->trans_head + i) % SHIM_RMT_TX_QUEUE].symbols);
+    free(channel->last.symbols);
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    if (channel->enabled) return ESP_ERR_INVALID_STATE;
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    if (!channel->enabled) return ESP_ERR_INVALID_STATE;
+    channel->enabled = false;
+    channel->rx_buffer = NULL;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    if (!ret_encoder) return ESP_ERR_INVALID_ARG;
+    *ret_encoder = calloc(1, sizeof(struct rmt_encoder_t));
+    return *ret_encoder ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    if (!encoder) return ESP_ERR_INVALID_ARG;
+    free(encoder);
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_tx_event_callbacks_t* cbs, void* user_data) {
+    if (!channel || !channel->tx || !cbs) return ESP_ERR_INVALID_ARG;
+    if (channel->enabled) return ESP_ERR_INVALID_STATE;
+    channel->on_trans_done = cbs->on_trans_done;
+    channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_rx_event_callbacks_t* cbs, void* user_data) {
+    if (!channel || channel->tx || !cbs) return ESP_ERR_INVALID_ARG;
+    if (channel->enabled) return ESP_ERR_INVALID_STATE;
+    channel->on_recv_done = cbs->on_recv_done;
+    channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void* payload, size_t payload_bytes, const rmt_transmit_config_t* config) {
+    if (!channel || !channel->tx || !encoder || !payload || !config) return ESP_ERR_INVALID_ARG;
+    if (!channel->enabled) return ESP_ERR_INVALID_STATE;
+    if (channel->trans_count == channel->queue_depth) return ESP_ERR_INVALID_STATE;
+
+    const size_t count = payload_bytes / sizeof(rmt_symbol_word_t);
+    ShimRmtTrans* trans = &channel->trans[(channel->trans_head + channel->trans_count) % SHIM_RMT_TX_QUEUE];
+    trans->symbols = malloc(count ? count * sizeof(rmt_symbol_word_t) : 1);
+    if (!trans->symbols) return ESP_ERR_NO_MEM;
+    memcpy(trans->symbols, payload, count * sizeof(rmt_symbol_word_t));
+    trans->count = count;
+    trans->loop_count = config->loop_count;
+    channel->trans_count++;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms) {
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    while (shim_rmt_tx_complete(channel)) {}
+    return ESP_OK;
+}
+
+esp_err_t rmt_receive(rmt_channel_handle_t channel, void* buffer, size_t buffer_size, const rmt_receive_config_t* config) {
+    if (!channel || channel->tx || !buffer || !config) return ESP_ERR_INVALID_ARG;
+    if (!channel->enabled) return ESP_ERR_INVALID_STATE;
+    channel->rx_buffer = buffer;
+    channel->rx_size = buffer_size / sizeof(rmt_symbol_word_t);
+    return ESP_OK;
+}
+
+bool shim_rmt_tx_complete(rmt_channel_handle_t channel) {
+    if (!channel->trans_count) return false;
+    free(channel->last.symbols);
+    channel->last = channel->trans[channel->trans_head];
+    channel->trans_head = (channel->trans_head + 1) % SHIM_RMT_TX_QUEUE;
+    channel->trans_count--;
+
+    const rmt_tx_done_event_data_t edata = { .num_symbols = channel->last.count };
+    if (channel->on_trans_done) channel->on_trans_done(channel, &edata, channel->user_data);
+    return true;
+}
+
+size_t shim_rmt_tx_symbols(rmt_channel_handle_t channel, const rmt_symbol_word_t** symbols) {
+    const ShimRmtTrans* trans = channel->trans_count ? &channel->trans[channel->trans_head] : &channel->last;
+    *symbols = trans->symbols;
+    return trans->count;
+}
+
+int shim_rmt_tx_loop_count(rmt_channel_handle_t channel) {
+    return channel->trans_count ? channel->trans[channel->trans_head].loop_count : channel->last.loop_count;
+}
+
+bool shim_rmt_rx_feed(rmt_channel_handle_t channel, const rmt_symbol_word_t* symbols, size_t count, bool is_last) {
+    if (!channel->enabled || !channel->rx_buffer) return false;
+    rmt_symbol_word_t* buffer = channel->rx_buffer;
+    if (count > channel->rx_size) count = channel->rx_size;
+    memcpy(buffer, symbols, count * sizeof(rmt_symbol_word_t));
+    // A finished receive needs a new rmt_receive, a partial one keeps the buffer
+    if (is_last) channel->rx_buffer = NULL;
+
+    const rmt_rx_done_event_data_t edata = {
+        .received_symbols = buffer,
+        .num_symbols = count,
+        .flags.is_last = is_last,
+    };
+    if (channel->on_recv_done) channel->on_recv_done(channel, &edata, channel->user_data);
+    return true;
+}
+
+bool shim_rmt_rx_pending(rmt_channel_handle_t channel) {
+    return channel->enabled && channel->rx_buffer;
+}
@@ -0,0 +1,105 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_sys.h"
+#include "nvs.h"
+#include "shim.h"
+#include "shim_internal.h"
+
+static esp_log_level_t log_level = ESP_LOG_ERROR;
+
+void shim_log(esp_log_level_t level, const char* tag, const char* format, ...) {
+    if (level > log_level) return;
+    static const char letters[] = "NEWID";
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%s) ", letters[level], tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void shim_log_level(esp_log_level_t level) {
+    log_level = level;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+// Busy waits only sleep the calling thread, the virtual clock does not move
+void esp_rom_delay_us(uint32_t us) {
+    usleep(us);
+}
+
+void* heap_caps_malloc(size_t size, unsigned caps) {
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, unsigned caps) {
+    return calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* handle) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* length) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+    return NULL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void shim_reset(void) {
+    shim_clock_reset();
+    shim_gpio_reset();
+}
@@ -0,0 +1,123 @@
+// Per-remote timing profiles: narrowing on clean frames, widening on near misses, the base tolerance as the limit
+#include "rf_common.h"
+#include "test_util.h"
+
+#define TEST_PROTO 0
+#define TEST_BITS 24
+#define TEST_VALUE 0x5A3C96ULL
+
+static RFProtoIndex index_;
+static RFCalibration calib;
+
+/* One framed repeat the way the framer hands it over: the sync gap first, the data pulses, the sync high.
+The first long data pulse is stretched by stretch percent of the unit */
+static uint32_t build_frame(uint32_t* timings, uint64_t value, uint32_t stretch) {
+    RFPulse pulses[RF_MAX_PULSES];
+    RFCode code;
+    rf_code_from_u64(&code, value);
+    const size_t count = rf_encode_code(rf_proto_symbols(TEST_PROTO), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+    CHECK_EQ(count, TEST_BITS * 2 + 2);
+    timings[0] = RF_PULSE_TICKS(pulses[count - 1]);
+    for (size_t i = 0; i < count - 1; i++) timings[i + 1] = RF_PULSE_TICKS(pulses[i]);
+
+    const uint32_t unit = proto[TEST_PROTO].pulse_length;
+    for (size_t i = 1; i < count - 1; i++) {
+        if (timings[i] <= unit) continue;
+        timings[i] += unit * stretch / 100;
+        break;
+    }
+    return count;
+}
+
+static bool decode_value(uint64_t value, uint32_t stretch, RFRecvFrame* frame, uint32_t* rejected) {
+    uint32_t timings[RF_MAX_PULSES];
+    const uint32_t edge_count = build_frame(timings, value, stretch);
+    return rf_decode_calibrated(&calib, &index_, proto, timings, edge_count, RECV_TOLERANCE, frame, rejected);
+}
+
+static bool decode(uint32_t stretch, RFRecvFrame* frame, uint32_t* rejected) {
+    return decode_value(TEST_VALUE, stretch, frame, rejected);
+}
+
+static const RFTimingProfile* profile_of(uint64_t value) {
+    RFCode code;
+    rf_code_from_u64(&code, value);
+    return rf_calib_lookup(&calib, TEST_PROTO, &code, TEST_BITS);
+}
+
+static const RFTimingProfile* profile(void) {
+    return profile_of(TEST_VALUE);
+}
+
+// Clean frames narrow the profile down to the floor
+static void test_narrow(void) {
+    RFRecvFrame frame;
+    for (uint8_t i = 0; i < RF_CALIB_MIN_HITS + 2; i++)
+        CHECK(decode(0, &frame, NULL));
+    CHECK_EQ(frame.proto, TEST_PROTO);
+    CHECK(profile() && profile()->hits == RF_CALIB_MIN_HITS + 2);
+    CHECK_EQ(profile()->tolerance, RF_CALIB_MIN_TOLERANCE);
+}
+
+// A drifted remote is outside its narrowed profile but within the base tolerance: it decodes and widens the profile
+static void test_near_miss(void) {
+    const uint32_t stretch = RF_CALIB_MIN_TOLERANCE + 15;
+    RFRecvFrame frame;
+    uint32_t rejected;
+    CHECK(decode(stretch, &frame, &rejected));
+    CHECK_EQ(frame.proto, TEST_PROTO);
+    CHECK_EQ(rejected & (1UL << TEST_PROTO), 0);
+    CHECK(profile()->tolerance > stretch);
+    // The widened profile takes the next drifted frame as a regular fit
+    const uint16_t hits = profile()->hits;
+    CHECK(decode(stretch, &frame, NULL));
+    CHECK_EQ(profile()->hits, hits + 1);
+    CHECK(profile()->tolerance <= RECV_TOLERANCE);
+}
+
+// Past the base tolerance nothing decodes and the profile is left alone
+static void test_beyond_base(void) {
+    const RFTimingProfile before = *profile();
+    RFRecvFrame frame;
+    CHECK(!decode(RECV_TOLERANCE + 20, &frame, NULL));
+    CHECK_EQ(profile()->hits, before.hits);
+    CHECK_EQ(profile()->tolerance, before.tolerance);
+}
+
+/* A full table makes room with the least recently seen remote, so a new remote keeps its profile
+when another unknown one shows up next, and a reused slot starts from the base tolerance */
+static void test_eviction(void) {
+    RFRecvFrame frame;
+    for (uint32_t i = 0; i < RF_CALIB_PROFILES; i++) {
+        for (uint8_t n = 0; n < RF_CALIB_MIN_HITS; n++)
+            CHECK(decode_value(0x100000 + i, 0, &frame, NULL));
+    }
+    CHECK_EQ(calib.count, RF_CALIB_PROFILES);
+
+    CHECK(decode_value(0x200001, 0, &frame, NULL));
+    CHECK(profile_of(0x200001));
+    CHECK_EQ(profile_of(0x200001)->tolerance, RECV_TOLERANCE);
+    CHECK(!profile_of(0x100000));
+    CHECK(decode_value(0x200002, 0, &frame, NULL));
+    CHECK(profile_of(0x200001) && profile_of(0x200002));
+    CHECK(!profile_of(0x100001));
+
+    for (uint8_t n = 1; n < RF_CALIB_MIN_HITS; n++)
+        CHECK(decode_value(0x200001, 0, &frame, NULL));
+    CHECK_EQ(profile_of(0x200001)->hits, RF_CALIB_MIN_HITS);
+    CHECK(profile_of(0x200001)->tolerance < RECV_TOLERANCE);
+}
+
+int main(void) {
+    rf_proto_index_build_mask(&index_, proto, PROTO_COUNT, 1UL << TEST_PROTO);
+    rf_calib_reset(&calib, RF_CALIB_MIN_TOLERANCE);
+
+    test_narrow();
+    test_near_miss();
+    test_beyond_base();
+    rf_calib_reset(&calib, RF_CALIB_MIN_TOLERANCE);
+    test_eviction();
+
+    printf("test_calib: ok\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Millions of codes through the result decoder, with the allocator wrapped to count heap use
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include "rf_common.h"
+#include "test_util.h"
+
+#define RX_GPIO GPIO_NUM_4
+#define SOAK_THREADS 4
+#define SOAK_CODES_PER_THREAD 1000000
+#define SOAK_FRAMES 2000
+
+static atomic_long allocs, frees;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    atomic_fetch_add(&allocs, 1);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    atomic_fetch_add(&allocs, 1);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (!ptr) atomic_fetch_add(&allocs, 1);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) atomic_fetch_add(&frees, 1);
+    __real_free(ptr);
+}
+
+static long net_allocs(void) {
+    return atomic_load(&allocs) - atomic_load(&frees);
+}
+
+static uint64_t next_rand(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// The strings rebuilt bit by bit from the most significant one
+static void check_decoded(const RFCode* code, uint8_t bit_length, const RFRecvData* data, bool has_tri) {
+    char tri_state[RF_MAX_SYMBOLS + 1];
+    CHECK_EQ(strlen(data->binary), bit_length);
+    for (uint8_t j = 0; j < bit_length; j++)
+        CHECK_EQ(data->binary[j], '0' + rf_code_bit(code, bit_length - 1 - j));
+    bool tri = true;
+    for (uint8_t j = 0; j < bit_length / 2; j++) {
+        const uint8_t high = rf_code_bit(code, bit_length - 1 - j * 2), low = rf_code_bit(code, bit_length - 2 - j * 2);
+        tri_state[j] = high ? '1' : (low ? 'F' : '0');
+        tri &= !high || low;
+    }
+    tri_state[tri ? bit_length / 2 : 0] = '\0';
+    CHECK_EQ(has_tri, tri);
+    CHECK(strcmp(data->tri_state, tri_state) == 0);
+}
+
+// Each thread decodes its own codes at the same time as the others, nothing is shared
+static void* soak_thread(void* arg) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL * ((uintptr_t)arg + 1);
+    RFRecvFrame frame = { 0 };
+    RFRecvData data;
+    for (uint32_t i = 0; i < SOAK_CODES_PER_THREAD; i++) {
+        frame.bit_length = 1 + next_rand(&state) % RF_MAX_CODE_BITS;
+        for (uint8_t w = 0; w < RF_CODE_WORDS; w++) frame.code.words[w] = (uint32_t)next_rand(&state);
+        // Every other code has an even length and no '10' pair, so it has a tri-state form
+        if (i & 1) {
+            frame.bit_length = frame.bit_length < 2 ? 2 : frame.bit_length & ~1;
+            for (uint8_t w = 0; w < RF_CODE_WORDS; w++) frame.code.words[w] |= (frame.code.words[w] & 0xAAAAAAAAUL) >> 1;
+        }
+        // Bits past bit_length are left set, the decoder must not look at them
+        const esp_err_t err = rf_decode_frame(&frame, &data);
+        CHECK(err == ESP_OK || err == ESP_ERR_INVALID_RESPONSE);
+        check_decoded(&frame.code, frame.bit_length, &data, err == ESP_OK);
+        if ((i & 1023) == 0) output_recv(&frame);
+    }
+    return NULL;
+}
+
+static void test_decode_soak(void) {
+    pthread_t threads[SOAK_THREADS];
+    const long before = net_allocs();
+    const long allocs_before = atomic_load(&allocs);
+    for (uintptr_t t = 0; t < SOAK_THREADS; t++)
+        CHECK_EQ(pthread_create(&threads[t], NULL, soak_thread, (void*)t), 0);
+    for (uint8_t t = 0; t < SOAK_THREADS; t++)
+        pthread_join(threads[t], NULL);
+    CHECK_EQ(atomic_load(&allocs), allocs_before);
+    CHECK_EQ(net_allocs(), before);
+}
+
+// Codes received through the ISR, the decoder task and the ring leave the heap where it was
+static void test_receive_soak(void) {
+    RFReceiver rf_recv;
+    const long created = atomic_load(&allocs);
+    CHECK_OK(rf_recv_create(0, &rf_recv));
+    // The receiver's task and queues come from the heap, so the counters do see it
+    CHECK(atomic_load(&allocs) > created);
+    CHECK_OK(rf_recv_init(RX_GPIO, &rf_recv));
+    shim_advance(100000);
+
+    RFSim sim;
+    const RFSimConfig config = { .seed = 7 };
+    rf_sim_init(&sim, &config);
+    TestPin pin = { .gpio = RX_GPIO, .level = 0 };
+    uint64_t state = 1;
+    RFRecvFrame frame;
+    RFPulse pulses[RF_MAX_PULSES];
+
+    // The first frame warms up whatever is created lazily
+    long before = 0;
+    for (uint32_t i = 0; i <= SOAK_FRAMES; i++) {
+        if (i == 1) before = net_allocs();
+        RFCode code;
+        rf_code_from_u64(&code, next_rand(&state) & 0xFFFFFF);
+        const size_t count = rf_encode_code(rf_proto_symbols(0), &code, 24, pulses, RF_MAX_PULSES);
+        rf_sim_play(&sim, pulses, count, 4, test_pin_edge, &pin);
+        rf_sim_idle(&sim, 20000, test_pin_edge, &pin);
+        bool found = false;
+        while (rf_recv_wait(&rf_recv, &frame, pdMS_TO_TICKS(found ? 0 : 1000)) == ESP_OK) {
+            found |= rf_code_equal(&frame.code, &code);
+            output_recv(&frame);
+        }
+        CHECK(found);
+    }
+    CHECK_EQ(net_allocs(), before);
+
+    CHECK_OK(rf_recv_destroy(&rf_recv));
+}
+
+int main(void) {
+    shim_reset();
+    test_decode_soak();
+    test_receive_soak();
+    printf("test_decode_soak: ok (%d codes)\n", SOAK_THREADS * SOAK_CODES_PER_THREAD + SOAK_FRAMES);
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Two receivers on separate pins, their edges interleaved in time on one ISR service and one decoder task
+#include <string.h>
+#include "rf_common.h"
+#include "test_util.h"
+
+#define TEST_REPEAT 4
+#define TEST_BITS 24
+#define MAX_PIN_EDGES (TEST_REPEAT * RF_MAX_PULSES + 4)
+
+static const gpio_num_t rx_gpio[2] = { GPIO_NUM_4, GPIO_NUM_6 };
+
+typedef struct {
+    int64_t time[MAX_PIN_EDGES];
+    size_t count;
+} EdgeTimes;
+
+static void record_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    EdgeTimes* edges = (EdgeTimes*)ctx;
+    CHECK(edges->count < MAX_PIN_EDGES);
+    edges->time[edges->count] = (edges->count ? edges->time[edges->count - 1] : 0) + duration;
+    edges->count++;
+}
+
+// Absolute edge times of one transmission and the gap after it, starting at offset
+static void transmission_edges(uint8_t proto_idx, uint64_t value, int64_t offset, EdgeTimes* edges) {
+    RFPulse pulses[RF_MAX_PULSES];
+    RFCode code;
+    rf_code_from_u64(&code, value);
+    const size_t count = rf_encode_code(rf_proto_symbols(proto_idx), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+    CHECK(count > 0);
+
+    RFSim sim;
+    const RFSimConfig config = { .seed = 1 };
+    rf_sim_init(&sim, &config);
+    edges->count = 0;
+    rf_sim_play(&sim, pulses, count, TEST_REPEAT, record_edge, edges);
+    rf_sim_idle(&sim, 20000, record_edge, edges);
+    for (size_t i = 0; i < edges->count; i++) edges->time[i] += offset;
+}
+
+static void play_interleaved(const EdgeTimes* edges) {
+    size_t next[2] = { 0, 0 };
+    uint8_t level[2] = { gpio_get_level(rx_gpio[0]), gpio_get_level(rx_gpio[1]) };
+    while (next[0] < edges[0].count || next[1] < edges[1].count) {
+        int r = next[1] >= edges[1].count ? 0 : next[0] >= edges[0].count ? 1
+            : edges[0].time[next[0]] <= edges[1].time[next[1]] ? 0 : 1;
+        shim_advance_to(edges[r].time[next[r]++]);
+        level[r] ^= 1;
+        shim_gpio_input(rx_gpio[r], level[r]);
+    }
+}
+
+int main(void) {
+    static EdgeTimes edges[2];
+    static RFReceiver receivers[2];
+    RFReceiver* const handles[2] = { &receivers[0], &receivers[1] };
+
+    shim_reset();
+    for (uint8_t r = 0; r < 2; r++) {
+        CHECK_OK(rf_recv_create(r, &receivers[r]));
+        CHECK_OK(rf_recv_init(rx_gpio[r], &receivers[r]));
+    }
+    shim_advance(100000);
+
+    // Every pair of framed protocols, the second receiver starting part way into the first one's burst
+    uint32_t pairs = 0;
+    for (uint8_t a = 0; a < PROTO_COUNT; a++) {
+        for (uint8_t b = 0; b < PROTO_COUNT; b++) {
+            if (a == 3 || b == 3) continue;
+            const uint64_t value[2] = { 0x5A3C96 ^ (a << 8 | b), 0xC3A569 ^ (b << 8 | a) };
+            const int64_t start = esp_timer_get_time();
+            transmission_edges(a, value[0], start, &edges[0]);
+            transmission_edges(b, value[1], start + 137 * (1 + pairs % 50), &edges[1]);
+            play_interleaved(edges);
+            // Capture order holds across the frames already decoded, let the decoder task catch up
+            vTaskDelay(pdMS_TO_TICKS(30));
+
+            bool seen[2] = { false, false };
+            int64_t last = INT64_MIN;
+            RFRecvFrame frame;
+            while (rf_recv_wait_any(handles, 2, &frame, 0) == ESP_OK) {
+                CHECK(frame.rx_id < 2);
+                CHECK(frame.timestamp >= last);
+                last = frame.timestamp;
+                RFCode expected;
+                rf_code_from_u64(&expected, value[frame.rx_id]);
+                // Protocol 9 frames may be read as protocol 8, anything else must be exactly what was sent
+                const uint8_t sent = frame.rx_id ? b : a;
+                if (sent == 8) continue;
+                CHECK_EQ(frame.bit_length, TEST_BITS);
+                CHECK(rf_code_equal(&frame.code, &expected));
+                seen[frame.rx_id] = true;
+            }
+            CHECK(seen[0] || a == 8);
+            CHECK(seen[1] || b == 8);
+            pairs++;
+        }
+    }
+
+    for (uint8_t r = 0; r < 2; r++) {
+        RFRecvStats stats;
+        CHECK_OK(rf_recv_get_stats(&receivers[r], &stats));
+        CHECK_EQ(stats.overflows, 0);
+        CHECK_OK(rf_recv_destroy(&receivers[r]));
+    }
+    printf("test_multi_rx: %lu protocol pairs ok\n", (unsigned long)pairs);
+    return 0;
+}
@@ -0,0 +1,231 @@
+// The RMT capture backend fed through the RMT RX shim: whole bursts, partial chunks, split bursts and noise
+#include <string.h>
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "test_util.h"
+
+#define RX_GPIO GPIO_NUM_4
+#define TEST_REPEAT 4
+#define TEST_BITS 24
+#define CHUNK_SYMBOLS 64
+#define MAX_SYMBOLS 4096
+
+static RFReceiver rf_recv;
+static rmt_symbol_word_t symbols[MAX_SYMBOLS];
+static size_t symbol_count, half_count;
+
+static uint64_t test_value(uint8_t proto_idx) {
+    return (0x3A5C69ULL + proto_idx * 0x020301ULL) & ((1ULL << TEST_BITS) - 1);
+}
+
+static bool proto_sync_framed(const Protocol* protocol) {
+    const uint8_t sync = protocol->sync_factor.high > protocol->sync_factor.low ? protocol->sync_factor.high : protocol->sync_factor.low;
+    return (uint32_t)protocol->pulse_length * sync > SEPARATION_LIMIT;
+}
+
+static void symbols_reset(void) {
+    memset(symbols, 0, sizeof(symbols));
+    symbol_count = half_count = 0;
+}
+
+// Halves are packed two to a symbol the way the channel records them, high first
+static void symbols_push(uint8_t level, uint32_t duration) {
+    CHECK(symbol_count < MAX_SYMBOLS);
+    rmt_symbol_word_t* symbol = &symbols[symbol_count];
+    if (half_count & 1) {
+        symbol->level1 = level;
+        symbol->duration1 = duration;
+        symbol_count++;
+    } else {
+        symbol->level0 = level;
+        symbol->duration0 = duration;
+    }
+    half_count++;
+}
+
+// Pushes TEST_REPEAT repeats, returns the length of one repeat
+static uint32_t symbols_push_code(uint8_t proto_idx, uint32_t sync_stretch) {
+    RFPulse pulses[RF_MAX_PULSES];
+    RFCode code;
+    rf_code_from_u64(&code, test_value(proto_idx));
+    const size_t count = rf_encode_code(rf_proto_symbols(proto_idx), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+    CHECK(count > 0);
+    uint32_t repeat_us = 0;
+    for (uint8_t r = 0; r < TEST_REPEAT; r++) {
+        repeat_us = 0;
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t ticks = RF_PULSE_TICKS(pulses[i]);
+            symbols_push(RF_PULSE_LEVEL(pulses[i]), ticks > SEPARATION_LIMIT ? ticks + sync_stretch : ticks);
+            repeat_us += ticks > SEPARATION_LIMIT ? ticks + sync_stretch : ticks;
+        }
+    }
+    return repeat_us;
+}
+
+static void symbols_push_noise(RFSim* sim, uint32_t edges, uint32_t min_ticks, uint32_t max_ticks) {
+    for (uint32_t i = 0; i < edges; i++)
+        symbols_push(!(half_count & 1), min_ticks + rf_sim_rand(sim) % (max_ticks - min_ticks + 1));
+}
+
+static uint64_t symbols_duration(const rmt_symbol_word_t* from, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) total += from[i].duration0 + from[i].duration1;
+    return total;
+}
+
+// Time passes while the channel records, then the done callback runs and the decoder catches up
+static void feed(const rmt_symbol_word_t* from, size_t count, bool is_last) {
+    shim_advance(symbols_duration(from, count) + (is_last ? rf_recv.rmt_rx_idle_us : 0));
+    CHECK(shim_rmt_rx_feed(rf_recv.rx_chan, from, count, is_last));
+    while (__atomic_load_n(&rf_recv.rmt_rx_busy, __ATOMIC_ACQUIRE))
+        vTaskDelay(1);
+}
+
+// The last pulse of a capture is the low that ran into the idle threshold, the channel records it as 0
+static void feed_capture(void) {
+    if (half_count & 1) symbol_count++;
+    symbols[symbol_count - 1].duration1 = 0;
+    feed(symbols, symbol_count, true);
+}
+
+// Frames carrying value, first is the timestamp of the earliest one
+static uint32_t count_frames(uint64_t value, int64_t* first) {
+    RFRecvFrame frame;
+    RFCode expected;
+    rf_code_from_u64(&expected, value);
+    uint32_t frames = 0;
+    while (rf_recv_wait(&rf_recv, &frame, pdMS_TO_TICKS(200)) == ESP_OK) {
+        if (frame.bit_length != TEST_BITS || !rf_code_equal(&frame.code, &expected)) continue;
+        if (first && (!frames || frame.timestamp < *first)) *first = frame.timestamp;
+        frames++;
+    }
+    return frames;
+}
+
+static void receiver_start(uint32_t protocols, uint32_t max_edge_rate, uint32_t mute_us) {
+    CHECK_OK(rf_recv_set_backend(&rf_recv, RF_RX_BACKEND_RMT));
+    CHECK_OK(rf_recv_set_protocols(&rf_recv, protocols));
+    CHECK_OK(rf_recv_set_frontend(&rf_recv, 0, max_edge_rate, mute_us));
+    CHECK_OK(rf_recv_init(RX_GPIO, &rf_recv));
+}
+
+/* One capture per burst. The framer closes every other repeat, the burst's own sync frames the first
+one, so it decodes and ends where the first sync starts */
+static void test_burst(void) {
+    receiver_start(UINT32_MAX, 0, 0);
+    for (uint8_t i = 0; i < PROTO_COUNT; i++) {
+        if (!proto_sync_framed(&proto[i]) || proto[i].inverted) continue;
+        symbols_reset();
+        const int64_t start = esp_timer_get_time();
+        const uint32_t repeat_us = symbols_push_code(i, 0);
+        feed_capture();
+        int64_t first = 0;
+        CHECK_EQ(count_frames(test_value(i), &first), TEST_REPEAT / 2);
+        CHECK_EQ(first, start + repeat_us - proto[i].pulse_length * proto[i].sync_factor.low);
+        shim_advance(100000);
+    }
+    CHECK_OK(rf_recv_deinit(&rf_recv, false));
+}
+
+// A line that never goes idle arrives in chunks, frames span the chunk boundaries
+static void test_partial(void) {
+    receiver_start(1UL << 0, 0, 0);
+    RFSim sim;
+    const RFSimConfig config = { .seed = 3 };
+    rf_sim_init(&sim, &config);
+    symbols_reset();
+    symbols_push_noise(&sim, 301, 150, 900);
+    symbols_push_code(0, 0);
+    symbols_push_noise(&sim, 300, 150, 900);
+    for (size_t i = 0; i < symbol_count; i += CHUNK_SYMBOLS)
+        feed(&symbols[i], symbol_count - i < CHUNK_SYMBOLS ? symbol_count - i : CHUNK_SYMBOLS, false);
+    // Noise in front of the burst leaves the first repeat without a gap in front
+    CHECK_EQ(count_frames(test_value(0), NULL), TEST_REPEAT / 2);
+    CHECK_OK(rf_recv_deinit(&rf_recv, false));
+}
+
+// Syncs a little over the idle threshold end a capture per frame, the gaps between captures frame them
+static void test_split_burst(void) {
+    receiver_start(1UL << 0, 0, 0);
+    const uint32_t sync = proto[0].pulse_length * proto[0].sync_factor.low;
+    const uint32_t stretch = rf_recv.rmt_rx_idle_us + 100 - sync;
+    CHECK(stretch < RF_FRAMER_GAP_MATCH * 2);
+    symbols_reset();
+    symbols_push_code(0, stretch);
+
+    // Cut after every sync high, the stretched low is the idle that ends each capture
+    static rmt_symbol_word_t capture[MAX_SYMBOLS];
+    size_t start = 0;
+    uint32_t captures = 0;
+    for (size_t i = 0; i < symbol_count; i++) {
+        if (symbols[i].duration1 <= SEPARATION_LIMIT) continue;
+        const size_t count = i - start + 1;
+        memcpy(capture, &symbols[start], count * sizeof(rmt_symbol_word_t));
+        capture[count - 1].duration1 = 0;
+        feed(capture, count, true);
+        // The rest of the gap passes before the next capture starts
+        shim_advance(symbols[i].duration1 - rf_recv.rmt_rx_idle_us);
+        start = i + 1;
+        captures++;
+    }
+    CHECK_EQ(captures, TEST_REPEAT);
+    // Only the first repeat has no gap in front, the others are framed by the gaps between captures
+    CHECK_EQ(count_frames(test_value(0), NULL), TEST_REPEAT - 1);
+    CHECK_OK(rf_recv_deinit(&rf_recv, false));
+}
+
+// A noise storm mutes the receiver, chunks are dropped until the re-arm timer, then codes decode again
+static void test_rate_limit(void) {
+    const uint32_t mute_us = 50000;
+    receiver_start(1UL << 0, RF_RECV_MAX_EDGE_RATE, mute_us);
+    RFSim sim;
+    const RFSimConfig config = { .seed = 5 };
+    rf_sim_init(&sim, &config);
+
+    RFMetrics before, after;
+    rf_metrics_snapshot(&before);
+    symbols_reset();
+    symbols_push_noise(&sim, 2 * CHUNK_SYMBOLS * 8, 10, 30);
+    for (size_t i = 0; i < symbol_count; i += CHUNK_SYMBOLS)
+        feed(&symbols[i], CHUNK_SYMBOLS, false);
+    rf_metrics_snapshot(&after);
+    CHECK_EQ(after.counters[RF_METRIC_MUTES] - before.counters[RF_METRIC_MUTES], 1);
+    CHECK(rf_recv.recv_muted);
+    // Only the edges up to the rate limit reached the front-end
+    CHECK(after.counters[RF_METRIC_EDGES] - before.counters[RF_METRIC_EDGES] <= rf_recv.recv_max_edges * 2);
+
+    shim_advance(mute_us);
+    CHECK(!rf_recv.recv_muted);
+    symbols_reset();
+    symbols_push_code(0, 0);
+    feed_capture();
+    CHECK_EQ(count_frames(test_value(0), NULL), TEST_REPEAT / 2);
+    CHECK_OK(rf_recv_deinit(&rf_recv, false));
+}
+
+// A channel that cannot be created leaves nothing allocated and the receiver inactive
+static void test_init_failure(void) {
+    CHECK_OK(rf_recv_set_backend(&rf_recv, RF_RX_BACKEND_RMT));
+    shim_log_level(ESP_LOG_NONE);
+    CHECK(rf_recv_init(GPIO_NUM_NC, &rf_recv) != ESP_OK);
+    shim_log_level(ESP_LOG_ERROR);
+    CHECK(!rf_recv.rx_chan);
+    CHECK(!rf_recv.rmt_rx_dma && !rf_recv.rmt_rx_buf[0] && !rf_recv.rmt_rx_buf[1]);
+    CHECK_EQ(rf_recv.rx_gpio, GPIO_NUM_NC);
+}
+
+int main(void) {
+    shim_reset();
+    CHECK_OK(rf_recv_create(0, &rf_recv));
+    shim_advance(100000);
+
+    test_burst();
+    test_partial();
+    test_split_burst();
+    test_rate_limit();
+    test_init_failure();
+
+    CHECK_OK(rf_recv_destroy(&rf_recv));
+    printf("test_rmt_rx: ok\n");
+    return 0;
+}
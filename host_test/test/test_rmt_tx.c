@@ -0,0 +1,96 @@
+// RMT transmit backend: the emitted symbol words against the pulse train and the GPTimer backend's edges
+#include <string.h>
+#include "rf_common.h"
+#include "test_util.h"
+
+#define TX_GPIO GPIO_NUM_5
+#define TEST_REPEAT 6
+#define TEST_MAX_EDGES (TEST_REPEAT * RF_MAX_PULSES + 1)
+
+static int64_t rmt_times[TEST_MAX_EDGES], timer_times[TEST_MAX_EDGES];
+static uint8_t rmt_levels[TEST_MAX_EDGES], timer_levels[TEST_MAX_EDGES];
+
+// Level changes of a train of symbols played back to back from a low line
+static size_t symbol_edges(const rmt_symbol_word_t* symbols, size_t count, int64_t* time, uint8_t* level,
+        int64_t* times, uint8_t* levels, size_t edges) {
+    for (size_t s = 0; s < count; s++) {
+        const uint16_t ticks[2] = { symbols[s].duration0, symbols[s].duration1 };
+        const uint8_t halves[2] = { symbols[s].level0, symbols[s].level1 };
+        for (int h = 0; h < 2; h++) {
+            if (halves[h] != *level) {
+                CHECK(edges < TEST_MAX_EDGES);
+                *level = halves[h];
+                times[edges] = *time;
+                levels[edges++] = *level;
+            }
+            *time += ticks[h];
+        }
+    }
+    return edges;
+}
+
+static void check_train(uint8_t proto_idx, uint8_t bits, uint64_t value) {
+    RFTransmitter rf_rmt = { 0 };
+    CHECK_OK(rf_init(TX_GPIO, TEST_REPEAT, (Protocol*)&proto[proto_idx], &rf_rmt));
+    CHECK_OK(rf_rmt_tx_init(&rf_rmt));
+    RFCode code;
+    rf_code_from_u64(&code, value);
+    CHECK_OK(translate_binary(&code, bits, &rf_rmt));
+    const size_t symbol_count = rf_rmt.pulse_count / 2;
+    CHECK_OK(rf_send(&rf_rmt));
+
+    // Short trains loop in hardware, longer ones are queued once per repeat
+    const bool hw_loop = symbol_count < RF_RMT_TX_MEM_SYMBOLS;
+    const int transactions = hw_loop ? 1 : TEST_REPEAT;
+    size_t edges = 0;
+    int64_t time = 0;
+    uint8_t level = 0;
+    for (int t = 0; t < transactions; t++) {
+        CHECK(rf_rmt.tx_active);
+        const rmt_symbol_word_t* symbols;
+        CHECK_EQ(shim_rmt_tx_symbols(rf_rmt.tx_chan, &symbols), symbol_count);
+        CHECK_EQ(shim_rmt_tx_loop_count(rf_rmt.tx_chan), hw_loop ? TEST_REPEAT : 0);
+        for (size_t s = 0; s < symbol_count; s++) {
+            CHECK_EQ(symbols[s].duration0, RF_PULSE_TICKS(rf_rmt.pulses[2 * s]));
+            CHECK_EQ(symbols[s].level0, RF_PULSE_LEVEL(rf_rmt.pulses[2 * s]));
+            CHECK_EQ(symbols[s].duration1, RF_PULSE_TICKS(rf_rmt.pulses[2 * s + 1]));
+            CHECK_EQ(symbols[s].level1, RF_PULSE_LEVEL(rf_rmt.pulses[2 * s + 1]));
+        }
+        for (int loop = 0; loop < (hw_loop ? TEST_REPEAT : 1); loop++)
+            edges = symbol_edges(symbols, symbol_count, &time, &level, rmt_times, rmt_levels, edges);
+        CHECK(shim_rmt_tx_complete(rf_rmt.tx_chan));
+    }
+    CHECK(!rf_rmt.tx_active);
+    CHECK(!shim_rmt_tx_complete(rf_rmt.tx_chan));
+    // The end of transmission level is low
+    if (level) {
+        rmt_times[edges] = time;
+        rmt_levels[edges++] = 0;
+    }
+
+    // The same train from the per-edge GPTimer backend
+    CHECK_OK(rf_rmt_tx_deinit(&rf_rmt));
+    shim_gpio_trace_reset();
+    const int64_t start = esp_timer_get_time();
+    CHECK_OK(rf_send(&rf_rmt));
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK(!rf_rmt.tx_active);
+    const size_t timer_edges = shim_gpio_trace_pin(TX_GPIO, timer_times, timer_levels, TEST_MAX_EDGES);
+    CHECK_EQ(timer_edges, edges);
+    for (size_t e = 0; e < edges; e++) {
+        CHECK_EQ(timer_times[e] - start, rmt_times[e]);
+        CHECK_EQ(timer_levels[e], rmt_levels[e]);
+    }
+    CHECK_OK(rf_deinit(&rf_rmt));
+}
+
+int main(void) {
+    shim_reset();
+    for (uint8_t i = 0; i < PROTO_COUNT; i++) {
+        check_train(i, 12, 0xA5C);
+        check_train(i, 24, 0x5A3C96);
+        check_train(i, 64, 0xF0E1D2C3B4A59687ULL);
+    }
+    printf("test_rmt_tx: ok\n");
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Several transmit pins on the shared scheduler timer, every pin's edges checked against its own pulse train
+#include "rf_common.h"
+#include "test_util.h"
+
+#define TEST_REPEAT 3
+#define TEST_BITS 24
+#define TEST_CHANNELS 3
+#define TEST_EDGES (TEST_REPEAT * RF_MAX_PULSES + 1)
+
+// One pin past 32 so the OUT1 registers are driven too
+static const gpio_num_t pins[TEST_CHANNELS] = { GPIO_NUM_5, GPIO_NUM_18, GPIO_NUM_40 };
+static const uint8_t protos[TEST_CHANNELS] = { 0, 1, 4 };
+static uint32_t done_mask;
+
+static void send_done(uint32_t channel, esp_err_t err, void* arg) {
+    CHECK_OK(err);
+    done_mask |= 1UL << channel;
+}
+
+// Level changes a pin should make for the train, relative to its first edge
+static size_t expected_edges(const RFPulse* pulses, size_t count, int64_t* times, uint8_t* levels) {
+    size_t edges = 0;
+    uint8_t level = 0;
+    int64_t time = 0;
+    for (uint8_t r = 0; r < TEST_REPEAT; r++) {
+        for (size_t i = 0; i < count; i++) {
+            if (RF_PULSE_LEVEL(pulses[i]) != level) {
+                CHECK(edges < TEST_EDGES);
+                level = RF_PULSE_LEVEL(pulses[i]);
+                times[edges] = time;
+                levels[edges++] = level;
+            }
+            time += RF_PULSE_TICKS(pulses[i]);
+        }
+    }
+    if (level) {
+        times[edges] = time;
+        levels[edges++] = 0;
+    }
+    return edges;
+}
+
+/* Staggered sends overlap on the one timer. Merged edges may fire up to RF_SCHED_MERGE_TICKS early,
+never late, and the level sequence of every pin is its own train's */
+static void test_overlapping_sends(void) {
+    static RFTxScheduler rf_sched;
+    static int64_t want_times[TEST_EDGES], got_times[TEST_EDGES];
+    static uint8_t want_levels[TEST_EDGES], got_levels[TEST_EDGES];
+    RFPulse pulses[TEST_CHANNELS][RF_MAX_PULSES];
+    size_t counts[TEST_CHANNELS];
+    int64_t starts[TEST_CHANNELS];
+    uint8_t channels[TEST_CHANNELS];
+
+    CHECK_OK(rf_sched_tx_init(&rf_sched));
+    for (uint8_t c = 0; c < TEST_CHANNELS; c++)
+        CHECK_OK(rf_sched_tx_add_pin(&rf_sched, pins[c], &channels[c]));
+    shim_gpio_trace_reset();
+    done_mask = 0;
+
+    for (uint8_t c = 0; c < TEST_CHANNELS; c++) {
+        RFCode code;
+        rf_code_from_u64(&code, 0x5A3C96ULL + c * 0x010203ULL);
+        counts[c] = rf_encode_code(rf_proto_symbols(protos[c]), &code, TEST_BITS, pulses[c], RF_MAX_PULSES);
+        CHECK(counts[c] > 0);
+        starts[c] = esp_timer_get_time() + RF_SCHED_LEAD_TICKS;
+        CHECK_OK(rf_sched_tx_send(&rf_sched, channels[c], pulses[c], counts[c], TEST_REPEAT, send_done, NULL));
+        // The next send starts part way into this one
+        shim_gptimer_run(esp_timer_get_time() + 1777 * (c + 1), NULL, NULL);
+    }
+    shim_log_level(ESP_LOG_NONE);
+    CHECK_EQ(rf_sched_tx_send(&rf_sched, channels[0], pulses[0], counts[0], 1, NULL, NULL), ESP_ERR_INVALID_STATE);
+    shim_log_level(ESP_LOG_ERROR);
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK_EQ(done_mask, (1UL << TEST_CHANNELS) - 1);
+
+    for (uint8_t c = 0; c < TEST_CHANNELS; c++) {
+        const size_t want = expected_edges(pulses[c], counts[c], want_times, want_levels);
+        const size_t got = shim_gpio_trace_pin(pins[c], got_times, got_levels, TEST_EDGES);
+        CHECK_EQ(got, want);
+        for (size_t e = 0; e < got; e++) {
+            const int64_t early = starts[c] + want_times[e] - got_times[e];
+            CHECK(early >= 0 && early <= RF_SCHED_MERGE_TICKS);
+            CHECK_EQ(got_levels[e], want_levels[e]);
+        }
+        CHECK_EQ(gpio_get_level(pins[c]), 0);
+    }
+    CHECK_OK(rf_sched_tx_deinit(&rf_sched));
+}
+
+int main(void) {
+    shim_reset();
+    shim_advance(100000);
+
+    test_overlapping_sends();
+
+    printf("test_sched_tx: ok\n");
+    return 0;
+}
@@ -0,0 +1,324 @@
+// The firmware receiver and GPTimer transmitter on the shims, fed and checked through the GPIO pins
+#include <string.h>
+#include "rf_common.h"
+#include "test_util.h"
+
+#define RX_GPIO GPIO_NUM_4
+#define TX_GPIO GPIO_NUM_5
+#define TEST_REPEAT 4
+#define TEST_BITS 24
+
+static RFReceiver rf_recv;
+
+// The framer only splits frames on gaps past the separation limit, protocols with a shorter sync never decode
+static bool proto_sync_framed(const Protocol* protocol) {
+    const uint8_t sync = protocol->sync_factor.high > protocol->sync_factor.low ? protocol->sync_factor.high : protocol->sync_factor.low;
+    return (uint32_t)protocol->pulse_length * sync > SEPARATION_LIMIT;
+}
+
+static uint64_t test_value(uint8_t proto_idx) {
+    return (0x5A3C96ULL + proto_idx * 0x010203ULL) & ((1ULL << TEST_BITS) - 1);
+}
+
+static void drain(void) {
+    RFRecvFrame frame;
+    while (rf_recv_wait(&rf_recv, &frame, 0) == ESP_OK) {}
+}
+
+static bool wait_code(uint64_t value, uint8_t bits) {
+    RFRecvFrame frame;
+    RFCode expected;
+    rf_code_from_u64(&expected, value);
+    while (rf_recv_wait(&rf_recv, &frame, pdMS_TO_TICKS(1000)) == ESP_OK) {
+        if (frame.bit_length == bits && memcmp(&frame.code, &expected, sizeof(RFCode)) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Clean simulator edges on the receive pin reach the decoder through the ISR, the task and the ring
+static void test_receiver(void) {
+    for (uint8_t i = 0; i < PROTO_COUNT; i++) {
+        if (!proto_sync_framed(&proto[i])) continue;
+
+        RFPulse pulses[RF_MAX_PULSES];
+        RFCode code;
+        rf_code_from_u64(&code, test_value(i));
+        const size_t count = rf_encode_code(rf_proto_symbols(i), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+        CHECK(count > 0);
+
+        RFSim sim;
+        const RFSimConfig config = { .seed = 1 + i };
+        rf_sim_init(&sim, &config);
+        TestPin pin = { .gpio = RX_GPIO, .level = 0 };
+        rf_sim_play(&sim, pulses, count, TEST_REPEAT, test_pin_edge, &pin);
+        rf_sim_idle(&sim, 20000, test_pin_edge, &pin);
+
+        if (!wait_code(test_value(i), TEST_BITS)) {
+            fprintf(stderr, "protocol %d not decoded\n", i + 1);
+            exit(1);
+        }
+        drain();
+    }
+}
+
+static void play_code(uint8_t proto_idx, uint32_t seed) {
+    RFPulse pulses[RF_MAX_PULSES];
+    RFCode code;
+    rf_code_from_u64(&code, test_value(proto_idx));
+    const size_t count = rf_encode_code(rf_proto_symbols(proto_idx), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+    RFSim sim;
+    const RFSimConfig config = { .seed = seed };
+    rf_sim_init(&sim, &config);
+    TestPin pin = { .gpio = RX_GPIO, .level = 0 };
+    rf_sim_play(&sim, pulses, count, TEST_REPEAT, test_pin_edge, &pin);
+    rf_sim_idle(&sim, 20000, test_pin_edge, &pin);
+}
+
+/* An echo window that gated nothing is closed by the first edge after it, so the 32-bit
+window times do not bring it back when the clock wraps */
+static void test_echo_window_wrap(void) {
+    const int64_t opened = esp_timer_get_time();
+    rf_recv_echo_begin(&rf_recv, 100000);
+    shim_advance(200000);
+    play_code(0, 21);
+    CHECK(wait_code(test_value(0), TEST_BITS));
+    drain();
+    CHECK_EQ(rf_recv.recv_echo_start, rf_recv.recv_echo_end);
+
+    // The same code again where the window would sit after the wrap
+    shim_advance_to(opened + (1LL << 32));
+    play_code(0, 22);
+    CHECK(wait_code(test_value(0), TEST_BITS));
+    drain();
+}
+
+typedef struct {
+    TestPin pin;
+    RFSimReceiver model;
+} TestTee;
+
+static void tee_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    TestTee* tee = (TestTee*)ctx;
+    test_pin_edge(&tee->pin, duration, timestamp);
+    rf_sim_rx_edge(&tee->model, duration, timestamp);
+}
+
+/* Impaired edges: whatever the core decodes from them, the firmware receiver must decode too,
+frame for frame */
+static void test_receiver_matches_core(void) {
+    static TestTee tee;
+    rf_sim_rx_init(&tee.model, proto, PROTO_COUNT, RECV_TOLERANCE, SEPARATION_LIMIT, false, 1);
+    tee.pin = (TestPin){ .gpio = RX_GPIO, .level = 0 };
+
+    RFSim sim;
+    const RFSimConfig config = { .seed = 7, .jitter = 5, .glitch_rate = 20, .drop_rate = 10, .glitch_ticks = 30 };
+    rf_sim_init(&sim, &config);
+    uint32_t model_frames = 0;
+    for (uint8_t round = 0; round < 8; round++) {
+        for (uint8_t i = 0; i < PROTO_COUNT; i++) {
+            RFPulse pulses[RF_MAX_PULSES];
+            RFCode code;
+            rf_code_from_u64(&code, test_value(i) ^ round);
+            const size_t count = rf_encode_code(rf_proto_symbols(i), &code, TEST_BITS, pulses, RF_MAX_PULSES);
+            rf_sim_play(&sim, pulses, count, TEST_REPEAT, tee_edge, &tee);
+            rf_sim_idle(&sim, 20000, tee_edge, &tee);
+
+            RFRecvFrame want, got;
+            while (rf_ring_pop(&tee.model.ring, &want)) {
+                CHECK_OK(rf_recv_wait(&rf_recv, &got, pdMS_TO_TICKS(1000)));
+                CHECK_EQ(got.proto, want.proto);
+                CHECK_EQ(got.bit_length, want.bit_length);
+                CHECK(memcmp(&got.code, &want.code, sizeof(RFCode)) == 0);
+                model_frames++;
+            }
+            CHECK_EQ(rf_recv_wait(&rf_recv, &got, pdMS_TO_TICKS(20)), ESP_ERR_TIMEOUT);
+        }
+    }
+    CHECK(model_frames > 0);
+}
+
+// Level changes the transmitter should make on its pin, relative to the send
+static size_t expected_edges(const RFPulse* pulses, size_t count, uint8_t repeat, int64_t* times, uint8_t* levels, size_t max) {
+    size_t edges = 0;
+    uint8_t level = 0;
+    int64_t time = 0;
+    for (uint8_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < count; i++) {
+            if (RF_PULSE_LEVEL(pulses[i]) != level) {
+                CHECK(edges < max);
+                level = RF_PULSE_LEVEL(pulses[i]);
+                times[edges] = time;
+                levels[edges++] = level;
+            }
+            time += RF_PULSE_TICKS(pulses[i]);
+        }
+    }
+    if (level) {
+        times[edges] = time;
+        levels[edges++] = 0;
+    }
+    return edges;
+}
+
+/* The timer ISR drives the pin at the protocol's exact edge times, and wired back to the receive
+pin the transmission decodes */
+static void test_transmitter(void) {
+    static int64_t want_times[TEST_REPEAT * RF_MAX_PULSES + 1], got_times[TEST_REPEAT * RF_MAX_PULSES + 1];
+    static uint8_t want_levels[TEST_REPEAT * RF_MAX_PULSES + 1], got_levels[TEST_REPEAT * RF_MAX_PULSES + 1];
+    const size_t max = TEST_REPEAT * RF_MAX_PULSES + 1;
+
+    shim_gpio_wire(TX_GPIO, RX_GPIO);
+    for (uint8_t i = 0; i < PROTO_COUNT; i++) {
+        RFTransmitter rf_rmt = { 0 };
+        CHECK_OK(rf_init(TX_GPIO, TEST_REPEAT, (Protocol*)&proto[i], &rf_rmt));
+        RFCode code;
+        rf_code_from_u64(&code, test_value(i));
+        CHECK_OK(translate_binary(&code, TEST_BITS, &rf_rmt));
+
+        shim_gpio_trace_reset();
+        const int64_t start = esp_timer_get_time();
+        CHECK_OK(rf_send(&rf_rmt));
+        shim_gptimer_run(INT64_MAX, NULL, NULL);
+        CHECK(!rf_rmt.tx_active);
+
+        const size_t want = expected_edges(rf_rmt.pulses, rf_rmt.pulse_count, TEST_REPEAT, want_times, want_levels, max);
+        const size_t got = shim_gpio_trace_pin(TX_GPIO, got_times, got_levels, max);
+        CHECK_EQ(got, want);
+        for (size_t e = 0; e < got; e++) {
+            CHECK_EQ(got_times[e] - start, want_times[e]);
+            CHECK_EQ(got_levels[e], want_levels[e]);
+        }
+
+        // The line must move again for the receiver to see the last gap
+        shim_advance(20000);
+        shim_gpio_input(RX_GPIO, 1);
+        shim_advance(100);
+        shim_gpio_input(RX_GPIO, 0);
+        if (proto_sync_framed(&proto[i])) CHECK(wait_code(test_value(i), TEST_BITS));
+        drain();
+        CHECK_OK(rf_deinit(&rf_rmt));
+    }
+    shim_gpio_wire(TX_GPIO, GPIO_NUM_NC);
+}
+
+// A one-off rf_send_code in another protocol leaves the configured train for the next rf_send
+static void test_send_code_keeps_train(void) {
+    RFTransmitter rf_rmt = { 0 };
+    CHECK_OK(rf_init(TX_GPIO, TEST_REPEAT, (Protocol*)&proto[0], &rf_rmt));
+    CHECK_OK(translate_tristate("0F0F0F0F0110", &rf_rmt));
+    RFPulse train[RF_MAX_PULSES];
+    const size_t train_count = rf_rmt.pulse_count;
+    memcpy(train, rf_rmt.pulses, train_count * sizeof(RFPulse));
+
+    CHECK_OK(rf_send_code(&rf_rmt, test_value(1), TEST_BITS, 1));
+    RFCode code;
+    RFPulse want[RF_MAX_PULSES];
+    rf_code_from_u64(&code, test_value(1));
+    CHECK_EQ(rf_encode_code(rf_proto_symbols(1), &code, TEST_BITS, want, RF_MAX_PULSES), rf_rmt.pulse_count);
+    CHECK(memcmp(rf_rmt.pulses, want, rf_rmt.pulse_count * sizeof(RFPulse)) == 0);
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK(!rf_rmt.tx_active);
+
+    CHECK_OK(rf_send(&rf_rmt));
+    CHECK_EQ(rf_rmt.pulse_count, train_count);
+    CHECK(memcmp(rf_rmt.pulses, train, train_count * sizeof(RFPulse)) == 0);
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK(!rf_rmt.tx_active);
+
+    // An invalid one-off code does not touch it either
+    CHECK(rf_send_tristate(&rf_rmt, 2, 1, 1) != ESP_OK);
+    CHECK_EQ(rf_rmt.pulse_count, train_count);
+    CHECK(memcmp(rf_rmt.pulses, train, train_count * sizeof(RFPulse)) == 0);
+    CHECK_OK(rf_deinit(&rf_rmt));
+}
+
+// Prepared codes are found again rather than re-stored, and send exactly the pulses rf_encode_code makes
+static void test_send_prepared(void) {
+    static RFTxCache cache;
+    static RFPulse arena[RF_MAX_PULSES * 4];
+    CHECK_OK(rf_tx_cache_init(&cache, arena, sizeof(arena) / sizeof(arena[0])));
+    RFCode code;
+    rf_code_from_u64(&code, test_value(2));
+    RFCacheHandle handle, again;
+    CHECK_OK(rf_tx_prepare(&cache, 2, &code, TEST_BITS, &handle));
+    CHECK_OK(rf_tx_prepare(&cache, 2, &code, TEST_BITS, &again));
+    CHECK_EQ(again, handle);
+    RFCacheStats stats;
+    CHECK_OK(rf_tx_cache_get_stats(&cache, &stats));
+    CHECK(stats.entries == 1 && stats.hits == 1 && stats.misses == 1);
+
+    RFTransmitter rf_rmt = { 0 };
+    CHECK_OK(rf_init(TX_GPIO, 1, (Protocol*)&proto[0], &rf_rmt));
+    CHECK_OK(rf_set_cache(&rf_rmt, &cache));
+    CHECK_OK(rf_send_prepared(&rf_rmt, handle));
+    RFPulse want[RF_MAX_PULSES];
+    CHECK_EQ(rf_encode_code(rf_proto_symbols(2), &code, TEST_BITS, want, RF_MAX_PULSES), rf_rmt.pulse_count);
+    CHECK(memcmp(rf_rmt.pulses, want, rf_rmt.pulse_count * sizeof(RFPulse)) == 0);
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK(!rf_rmt.tx_active);
+    CHECK_OK(rf_deinit(&rf_rmt));
+}
+
+/* Codes of mixed lengths churn through the cache with some of them pinned: pinned codes survive, and
+every code still cached holds exactly its own pulses, so reused gaps never overlap a live entry.
+Short codes in a large arena run out of entries before they run out of arena */
+static void test_cache_churn(uint32_t arena_pulses, uint8_t length_count) {
+    static RFTxCache cache;
+    static RFPulse arena[RF_CACHE_ENTRIES * 26];
+    CHECK(arena_pulses <= sizeof(arena) / sizeof(arena[0]));
+    CHECK_OK(rf_tx_cache_init(&cache, arena, arena_pulses));
+    static const uint8_t lengths[] = { 8, 12, 24, 32, 40 };
+    RFCacheHandle handles[160] = { 0 };
+    RFCacheHandle pinned[2];
+    uint32_t seed = 12345;
+
+    for (uint32_t i = 0; i < 160; i++) {
+        seed = seed * 1103515245 + 12345;
+        const uint8_t bits = lengths[(seed >> 16) % length_count];
+        RFCode code;
+        rf_code_from_u64(&code, i);
+        CHECK_OK(rf_tx_prepare(&cache, 0, &code, bits, &handles[i]));
+        if (i < 2) {
+            CHECK_OK(rf_tx_cache_pin(&cache, handles[i], true));
+            pinned[i] = handles[i];
+        }
+
+        uint32_t used = 0;
+        for (uint32_t j = 0; j <= i; j++) {
+            const RFCacheEntry* entry = rf_cache_get(&cache.cache, handles[j]);
+            if (!entry) continue;
+            RFPulse want[RF_MAX_PULSES];
+            CHECK_EQ(rf_encode_code(rf_proto_symbols(0), &entry->code, entry->bit_length, want, RF_MAX_PULSES), entry->count);
+            CHECK(memcmp(rf_cache_pulses(&cache.cache, entry), want, entry->count * sizeof(RFPulse)) == 0);
+            used += entry->count;
+        }
+        CHECK(rf_cache_get(&cache.cache, pinned[0]) && (i < 1 || rf_cache_get(&cache.cache, pinned[1])));
+        RFCacheStats stats;
+        CHECK_OK(rf_tx_cache_get_stats(&cache, &stats));
+        CHECK_EQ(stats.arena_used, used);
+    }
+    RFCacheStats stats;
+    CHECK_OK(rf_tx_cache_get_stats(&cache, &stats));
+    CHECK(stats.evictions > 0 && stats.failures == 0);
+}
+
+int main(void) {
+    shim_reset();
+    CHECK_OK(rf_recv_create(0, &rf_recv));
+    CHECK_OK(rf_recv_init(RX_GPIO, &rf_recv));
+    shim_advance(100000);
+
+    test_receiver();
+    test_receiver_matches_core();
+    test_echo_window_wrap();
+    test_transmitter();
+    test_send_code_keeps_train();
+    test_send_prepared();
+    test_cache_churn(RF_MAX_PULSES * 3, 5);
+    test_cache_churn(RF_CACHE_ENTRIES * 26, 2);
+
+    CHECK_OK(rf_recv_destroy(&rf_recv));
+    printf("test_sim: ok\n");
+    return 0;
+}
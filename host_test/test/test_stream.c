@@ -0,0 +1,132 @@
+/* Batch and stream decoding of the same traces must find the same codes. Traces are generated in
+the sniffer's RFT1 format, captures passed as arguments are checked the same way */
+#include <string.h>
+#include "rf_common.h"
+#include "test_util.h"
+
+#define TEST_CODES 16
+#define TEST_REPEAT 4
+#define TRACE_MAX (TEST_CODES * TEST_REPEAT * RF_MAX_PULSES * RF_TRACE_MAX_RECORD * 2)
+#define MAX_FRAMES 1024
+
+typedef struct {
+    RFRecvFrame frames[MAX_FRAMES];
+    size_t count;
+} FrameLog;
+
+typedef struct {
+    RFSimReceiver rx;
+    FrameLog* log;
+} LoggedReceiver;
+
+static void logged_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    LoggedReceiver* logged = (LoggedReceiver*)ctx;
+    rf_sim_rx_edge(&logged->rx, duration, timestamp);
+    RFRecvFrame frame;
+    while (rf_ring_pop(&logged->rx.ring, &frame)) {
+        CHECK(logged->log->count < MAX_FRAMES);
+        logged->log->frames[logged->log->count++] = frame;
+    }
+}
+
+static void decode_trace(const uint8_t* trace, size_t len, bool stream, FrameLog* log) {
+    static LoggedReceiver logged;
+    rf_sim_rx_init(&logged.rx, proto, PROTO_COUNT, RECV_TOLERANCE, SEPARATION_LIMIT, stream, 1);
+    logged.log = log;
+    log->count = 0;
+    RFSim sim;
+    const RFSimConfig config = { 0 };
+    rf_sim_init(&sim, &config);
+    CHECK(rf_sim_play_trace(&sim, trace, len, logged_edge, &logged));
+    rf_sim_idle(&sim, 10 * SEPARATION_LIMIT, logged_edge, &logged);
+}
+
+// The same code, or a frame at the same time the other decoder found ambiguous
+static bool log_has(const FrameLog* log, const RFRecvFrame* frame) {
+    for (size_t i = 0; i < log->count; i++) {
+        if (log->frames[i].bit_length == frame->bit_length && rf_code_equal(&log->frames[i].code, &frame->code))
+            return true;
+        if (log->frames[i].candidates > 1 && log->frames[i].timestamp == frame->timestamp)
+            return true;
+    }
+    return false;
+}
+
+/* Every code one decoder reports, the other reports too. Protocol 9 is protocol 8 with the
+levels inverted, so some frames fit both. Such frames may be read differently by the two decoders,
+and they are only compared when neither decoder reports them as ambiguous */
+static size_t check_equivalent(const char* name, const uint8_t* trace, size_t len) {
+    static FrameLog batch, stream;
+    decode_trace(trace, len, false, &batch);
+    decode_trace(trace, len, true, &stream);
+    for (size_t i = 0; i < batch.count; i++) {
+        if (batch.frames[i].candidates == 1 && !log_has(&stream, &batch.frames[i])) {
+            fprintf(stderr, "%s: batch frame %zu (protocol %d, %d bits) not decoded in stream mode\n",
+                name, i, batch.frames[i].proto + 1, batch.frames[i].bit_length);
+            exit(1);
+        }
+    }
+    for (size_t i = 0; i < stream.count; i++) {
+        if (stream.frames[i].candidates == 1 && !log_has(&batch, &stream.frames[i])) {
+            fprintf(stderr, "%s: stream frame %zu (protocol %d, %d bits) not decoded in batch mode\n",
+                name, i, stream.frames[i].proto + 1, stream.frames[i].bit_length);
+            exit(1);
+        }
+    }
+    return batch.count;
+}
+
+static size_t trace_pulses(uint8_t* trace, size_t len, const RFPulse* pulses, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        len += rf_trace_put(&trace[len], RF_PULSE_LEVEL(pulses[i]), RF_PULSE_TICKS(pulses[i]));
+    return len;
+}
+
+static void check_generated(uint8_t proto_idx, uint32_t seed) {
+    static uint8_t trace[TRACE_MAX];
+    size_t len = RF_TRACE_HEADER;
+    memcpy(trace, RF_TRACE_MAGIC, RF_TRACE_HEADER);
+
+    RFSim rng;
+    const RFSimConfig config = { .seed = seed };
+    rf_sim_init(&rng, &config);
+    for (uint16_t i = 0; i < TEST_CODES; i++) {
+        const uint8_t bits = 24 + (i % 3) * 8;
+        const uint64_t value = ((uint64_t)rf_sim_rand(&rng) << 32) | rf_sim_rand(&rng);
+        RFCode code;
+        rf_code_from_u64(&code, value & ((1ULL << bits) - 1));
+        RFPulse pulses[RF_MAX_PULSES];
+        const size_t count = rf_encode_code(rf_proto_symbols(proto_idx), &code, bits, pulses, RF_MAX_PULSES);
+        CHECK(count > 0);
+        for (uint8_t r = 0; r < TEST_REPEAT; r++)
+            len = trace_pulses(trace, len, pulses, count);
+        len += rf_trace_put(&trace[len], 0, 10 * SEPARATION_LIMIT);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "protocol %d", proto_idx + 1);
+    const size_t frames = check_equivalent(name, trace, len);
+    // Protocol 4 is never framed, see proto[]
+    if (proto_idx != 3) CHECK(frames >= TEST_CODES);
+}
+
+static void check_file(const char* path) {
+    static uint8_t trace[1 << 20];
+    FILE* file = fopen(path, "rb");
+    CHECK(file);
+    const size_t len = fread(trace, 1, sizeof(trace), file);
+    fclose(file);
+    CHECK(rf_trace_skip_header(trace, len) == RF_TRACE_HEADER);
+    printf("%s: %zu frames\n", path, check_equivalent(path, trace, len));
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) check_file(argv[i]);
+        return 0;
+    }
+    for (uint8_t i = 0; i < PROTO_COUNT; i++)
+        check_generated(i, 1 + i);
+    printf("test_stream: ok\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+/* The GPTimer transmitter's absolute schedule under interrupt latency: the real ISR of rf_timer.c
+with every alarm delayed, as measured by the tx_boundary histogram and the edges on the pin */
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "test_util.h"
+
+#define RX_GPIO GPIO_NUM_4
+#define TX_GPIO GPIO_NUM_5
+#define TEST_REPEAT 10
+#define TEST_BITS 24
+#define LATENCY_MIN 2
+#define LATENCY_MAX 12
+#define TEST_EDGES (TEST_REPEAT * RF_MAX_PULSES + 1)
+
+static uint32_t latency(void* ctx) {
+    return LATENCY_MIN + rf_sim_rand((RFSim*)ctx) % (LATENCY_MAX - LATENCY_MIN + 1);
+}
+
+/* Every repeat starts within one interrupt latency of its place in the schedule, so nothing builds up
+over the repeats. Each edge is late by its own latency only */
+static void test_boundaries(void) {
+    static int64_t times[TEST_EDGES];
+    static uint8_t levels[TEST_EDGES];
+    RFTransmitter rf_rmt = { 0 };
+    CHECK_OK(rf_init(TX_GPIO, TEST_REPEAT, (Protocol*)&proto[0], &rf_rmt));
+    RFCode code;
+    rf_code_from_u64(&code, 0x5A3C96);
+    CHECK_OK(translate_binary(&code, TEST_BITS, &rf_rmt));
+
+    RFSim sim;
+    const RFSimConfig config = { .seed = 9 };
+    rf_sim_init(&sim, &config);
+    rf_metrics_reset();
+    shim_gpio_trace_reset();
+    const int64_t start = esp_timer_get_time();
+    CHECK_OK(rf_send(&rf_rmt));
+    shim_gptimer_run(INT64_MAX, latency, &sim);
+    CHECK(!rf_rmt.tx_active);
+
+    RFMetrics metrics;
+    rf_metrics_snapshot(&metrics);
+    uint32_t boundaries = 0;
+    for (uint8_t b = 0; b < RF_METRICS_BUCKETS; b++) boundaries += metrics.hist[RF_HIST_TX_BOUNDARY][b];
+    // The first repeat starts in rf_send itself, every later one on an alarm
+    CHECK_EQ(boundaries, TEST_REPEAT - 1);
+    CHECK_EQ(metrics.hist[RF_HIST_TX_BOUNDARY][0] + metrics.hist[RF_HIST_TX_BOUNDARY][1], 0);
+    CHECK(metrics.hist_max[RF_HIST_TX_BOUNDARY] <= LATENCY_MAX);
+
+    const size_t count = shim_gpio_trace_pin(TX_GPIO, times, levels, TEST_EDGES);
+    const RFTxSchedule* schedule = &rf_rmt.tx_schedule;
+    size_t e = 1;
+    uint8_t level = RF_PULSE_LEVEL(rf_rmt.pulses[0]);
+    for (uint8_t r = 0; r < TEST_REPEAT; r++) {
+        for (uint16_t i = (r == 0); i < schedule->count; i++) {
+            const RFPulse pulse = rf_tx_schedule_pulse(schedule, rf_rmt.pulses, r, i);
+            if (RF_PULSE_LEVEL(pulse) == level) continue;
+            level = RF_PULSE_LEVEL(pulse);
+            CHECK(e < count);
+            const int64_t late = times[e++] - start - (int64_t)rf_tx_schedule_offset(schedule, r, i);
+            CHECK(late >= LATENCY_MIN && late <= LATENCY_MAX);
+        }
+    }
+    CHECK_EQ(count, e + (level ? 1 : 0));
+    CHECK_OK(rf_deinit(&rf_rmt));
+}
+
+// In duplex the echo window covers the whole schedule, a longer final sync included
+static void test_echo_window(void) {
+    RFReceiver rf_recv;
+    CHECK_OK(rf_recv_create(0, &rf_recv));
+    CHECK_OK(rf_recv_init(RX_GPIO, &rf_recv));
+    RFTransmitter rf_rmt = { 0 };
+    CHECK_OK(rf_init(TX_GPIO, 3, (Protocol*)&proto[0], &rf_rmt));
+    RFCode code;
+    rf_code_from_u64(&code, 0x5A3C96);
+    CHECK_OK(translate_binary(&code, TEST_BITS, &rf_rmt));
+    const RFPulse final_sync[2] = { RF_PULSE(1, 350), RF_PULSE(0, 30000) };
+    CHECK_OK(rf_set_final_sync(&rf_rmt, final_sync));
+    CHECK_OK(rf_set_receiver(&rf_rmt, &rf_recv));
+    CHECK_OK(rf_set_duplex(&rf_rmt, true));
+
+    CHECK_OK(rf_send(&rf_rmt));
+    const uint32_t length = (uint32_t)rf_tx_schedule_length(&rf_rmt.tx_schedule);
+    CHECK_EQ(rf_recv.recv_echo_end - rf_recv.recv_echo_start, length + length / 8 + RF_ECHO_GUARD_US);
+    shim_gptimer_run(INT64_MAX, NULL, NULL);
+    CHECK(!rf_rmt.tx_active);
+
+    CHECK_OK(rf_deinit(&rf_rmt));
+    CHECK_OK(rf_recv_destroy(&rf_recv));
+}
+
+int main(void) {
+    shim_reset();
+    shim_advance(100000);
+
+    test_boundaries();
+    test_echo_window();
+
+    printf("test_tx_schedule: ok\n");
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "shim.h"
+#include "rf_sim.h"
+
+#define CHECK(cond) do {                                                                \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b) do {                                                             \
+        const long long check_a_ = (long long)(a), check_b_ = (long long)(b);           \
+        if (check_a_ != check_b_) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",           \
+                __FILE__, __LINE__, #a, #b, check_a_, check_b_);                        \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_OK(x) CHECK_EQ((x), ESP_OK)
+
+// Pin driven by simulator edges, as RFSimEdgeCallback ctx
+typedef struct {
+    gpio_num_t gpio;
+    uint8_t level;
+} TestPin;
+
+// Holds the pin at its level for the edge's duration, then flips it through the GPIO shim
+static inline void test_pin_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    TestPin* pin = (TestPin*)ctx;
+    shim_advance(duration);
+    pin->level ^= 1;
+    shim_gpio_input(pin->gpio, pin->level);
+}
+
+#endif // TEST_UTIL_H
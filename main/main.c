@@ -11,28 +11,47 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "rf_metrics.h"
+#ifdef CONFIG_RF_SELFTEST
+#include "rf_loopback.h"
+#endif
+#ifdef CONFIG_RF_BENCH
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "rf_bench.h"
+#endif
 
 static void transmission_task(void* arg)
 {
     RFTransmitter* rf_rmt = (RFTransmitter*)arg;
-    const char* code = "FFFFFFFF";
-    const char* chn[4] = { "0001", "0010", "0100", "1000" };
+    // "FFFFFFFF" followed by "0001", "0010", "0100", "1000", packed 2 bits per symbol
+    const uint64_t code = 0x5555;
+    const uint8_t chn[4] = { 0x03, 0x0C, 0x30, 0xC0 };
+
+    // Encoded once, a packed tri-state code is the same pulses as its 2 bits per symbol read as binary
+    static RFPulse arena[4 * RF_MAX_PULSES];
+    static RFTxCache cache;
+    RFCacheHandle prepared[4];
+    ESP_ERROR_CHECK(rf_tx_cache_init(&cache, arena, sizeof(arena) / sizeof(arena[0])));
+    for (int i = 0; i < 4; i++) {
+        RFCode packed;
+        rf_code_from_u64(&packed, (code << 8) | chn[i]);
+        ESP_ERROR_CHECK(rf_tx_prepare(&cache, 0, &packed, 24, &prepared[i]));
+        ESP_ERROR_CHECK(rf_tx_cache_pin(&cache, prepared[i], true));
+    }
+    ESP_ERROR_CHECK(rf_set_cache(rf_rmt, &cache));
 
-    char buffer[13];
     while (1) {
         for (int i = 0; i < 4; i++) {
-            memset(buffer, 0, sizeof(buffer));
-            snprintf(buffer, sizeof(buffer), "%s%s", code, chn[i]);
-            translate_tristate(buffer, rf_rmt);
-            ESP_LOGI(TAG, "RF data prepared");
             vTaskDelay(pdMS_TO_TICKS(500));
 
             ESP_LOGI(TAG, "Waiting for transmission...");
-            ESP_ERROR_CHECK(rf_send(rf_rmt));
+            ESP_ERROR_CHECK(rf_send_prepared(rf_rmt, prepared[i]));
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
             ESP_LOGI(TAG, "Transmission completed");
-            if (rf_rmt->rx_gpio_state != GPIO_NUM_NC) {
-                ESP_ERROR_CHECK(rf_recv_init(rf_rmt->rx_gpio_state, rf_rmt));
+            // Only needed without duplex, where sending paused the receiver
+            if (rf_rmt->rx && rf_rmt->rx->rx_gpio == GPIO_NUM_NC && rf_rmt->rx->rx_gpio_state != GPIO_NUM_NC) {
+                ESP_ERROR_CHECK(rf_recv_init(rf_rmt->rx->rx_gpio_state, rf_rmt->rx));
                 ESP_LOGI(TAG, "RF receiver reinitialized");
             }
             vTaskDelay(pdMS_TO_TICKS(1000));
@@ -42,31 +61,125 @@ static void transmission_task(void* arg)
 
 static void reception_task(void* arg)
 {
-    RFTransmitter* rf_rmt = (RFTransmitter*)arg;
-    ESP_ERROR_CHECK(rf_recv_init(GPIO_NUM_41, rf_rmt));
+    RFReceiver* rf_recv = (RFReceiver*)arg;
+    ESP_ERROR_CHECK(rf_recv_init(GPIO_NUM_41, rf_recv));
     ESP_LOGI(TAG, "Waiting for RF reception...");
+    RFRecvFrame frame;
     while (1) {
-        if (recv_available(rf_rmt) == ESP_OK) {
-            output_recv(rf_rmt);
-            reset_recv(rf_rmt);
+        if (rf_recv_wait(rf_recv, &frame, portMAX_DELAY) == ESP_OK)
+            output_recv(&frame);
+    }
+}
+
+#ifdef CONFIG_RF_SELFTEST
+// TX timing against the schedule, idle and with interrupts held off by load tasks on every core
+static void run_selftest(RFTransmitter* rf_rmt)
+{
+    const RFSelftestConfig config = {
+        .protos = rf_protos(),
+        .proto_count = rf_proto_count(),
+        .tolerance = RECV_TOLERANCE,
+        .separation_limit = SEPARATION_LIMIT,
+        .codes_per_proto = 6,
+        .repeat = 4,
+        .seed = 1,
+    };
+    for (int loaded = 0; loaded < 2; loaded++) {
+        const RFLoopbackConfig loopback = {
+            .capture_gpio = GPIO_NUM_NC,
+            .load_tasks = loaded ? portNUM_PROCESSORS : 0,
+            .load_critical_us = 20,
+        };
+        RFSelftestResult result;
+        const esp_err_t err = rf_loopback_run(rf_rmt, &loopback, &config, &result);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Loopback self-test failed: %s", esp_err_to_name(err));
+            return;
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
+        rf_selftest_print(&result, stdout);
     }
 }
+#endif
+
+#ifdef CONFIG_RF_BENCH
+static uint64_t bench_clock(void)
+{
+    return (uint64_t)esp_timer_get_time() * 1000;
+}
+
+static uint32_t bench_cycles(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+// Replay the generated corpora through the core decoders, then report the live ISR cost
+static void bench_task(void* arg)
+{
+    RFReceiver* rf_recv = (RFReceiver*)arg;
+    static uint32_t trace[10000];
+    for (int stream = 0; stream < 2; stream++) {
+        for (int corpus = 0; corpus < RF_BENCH_CORPUS_COUNT; corpus++) {
+            const RFBenchConfig config = {
+                .protos = rf_protos(),
+                .proto_count = rf_proto_count(),
+                .tolerance = RECV_TOLERANCE,
+                .separation_limit = SEPARATION_LIMIT,
+                .stream = stream,
+                .codes_per_proto = 24,
+                .repeat = 4,
+                .jitter = 5,
+                .glitch_rate = 20,
+                .drop_rate = 10,
+                .noise_edges = 8000,
+                .seed = 1,
+                .trace = trace,
+                .trace_len = sizeof(trace) / sizeof(trace[0]),
+                .clock = bench_clock,
+                .cycles = bench_cycles,
+            };
+            RFBenchResult result;
+            if (rf_bench_run(&config, corpus, &result)) rf_bench_print(&result, stdout);
+            else ESP_LOGW(TAG, "Bench trace buffer too small");
+        }
+    }
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(10000));
+        RFRecvStats stats;
+        if (rf_recv_get_stats(rf_recv, &stats) != ESP_OK || !stats.isr_calls) continue;
+        printf("{\"isr_calls\":%lu,\"isr_cycles_mean\":%llu,\"isr_cycles_max\":%lu}\n",
+            stats.isr_calls, stats.isr_cycles / stats.isr_calls, stats.isr_max_cycles);
+    }
+}
+#endif
 
 void app_main(void)
 {
-    RFTransmitter rf_rmt;
+    static RFTransmitter rf_rmt;
+    static RFReceiver rf_recv;
     ESP_ERROR_CHECK(rf_init(GPIO_NUM_40, RC_SWITCH_REPEAT_COUNT, &proto[0], &rf_rmt));
+    ESP_ERROR_CHECK(rf_recv_create(0, &rf_recv));
+    ESP_ERROR_CHECK(rf_recv_set_frontend(&rf_recv, 60, RF_RECV_MAX_EDGE_RATE, RF_RECV_MUTE_US));
+    ESP_ERROR_CHECK(rf_set_receiver(&rf_rmt, &rf_recv));
+    ESP_ERROR_CHECK(rf_set_duplex(&rf_rmt, true));
+    ESP_ERROR_CHECK(rf_metrics_start_dump(60000));
 
     vTaskDelay(1000 / portTICK_PERIOD_MS);
 
+#ifdef CONFIG_RF_SELFTEST
+    run_selftest(&rf_rmt);
+#endif
+
     xTaskCreate(transmission_task, "transmission_task", 8192, &rf_rmt, 5, &rf_rmt.rf_trans_handle);
     ESP_LOGI(TAG, "RF transmission task created");
 
-    xTaskCreate(reception_task, "reception_task", 8192, &rf_rmt, 5, &rf_rmt.rf_recv_handle);
+    xTaskCreate(reception_task, "reception_task", 8192, &rf_recv, 5, &rf_recv.rf_recv_handle);
     ESP_LOGI(TAG, "RF reception task created");
 
+#ifdef CONFIG_RF_BENCH
+    xTaskCreate(bench_task, "bench_task", 8192, &rf_recv, 1, NULL);
+#endif
+
     while (1) {
         vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
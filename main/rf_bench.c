@@ -0,0 +1,137 @@
+#include <string.h>
+#include "rf_bench.h"
+
+static const char* corpus_names[RF_BENCH_CORPUS_COUNT] = { "clean", "jitter", "noise" };
+
+// Recorded trace: edge durations plus the edge index at which every transmission ends
+typedef struct {
+    uint32_t* durations;
+    size_t count, max;
+    bool overflow;
+} BenchTrace;
+
+typedef struct {
+    RFCode code;
+    uint8_t bit_length;
+    uint32_t end;
+} BenchTx;
+
+static void trace_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    (void)timestamp;
+    BenchTrace* trace = (BenchTrace*)ctx;
+    if (trace->count >= trace->max) {
+        trace->overflow = true;
+        return;
+    }
+    trace->durations[trace->count++] = duration;
+}
+
+static void replay(const RFBenchConfig* config, const BenchTrace* trace, const BenchTx* txs, uint32_t tx_count,
+        uint8_t proto_idx, RFSimReceiver* rx, RFBenchResult* result) {
+    uint32_t tx = 0;
+    bool detected = false;
+    int64_t time = 0;
+    RFRecvFrame frame;
+
+    const uint64_t start_ns = config->clock();
+    const uint32_t start_cycles = config->cycles ? config->cycles() : 0;
+    for (size_t i = 0; i < trace->count; i++) {
+        time += trace->durations[i];
+        rf_sim_rx_edge(rx, trace->durations[i], time);
+
+        while (tx < tx_count && i >= txs[tx].end) {
+            tx++;
+            detected = false;
+        }
+        while (rf_ring_pop(&rx->ring, &frame)) {
+            result->frames++;
+            if (tx < tx_count && frame.bit_length == txs[tx].bit_length && rf_code_equal(&frame.code, &txs[tx].code)) {
+                if (!detected) {
+                    result->detected++;
+                    result->proto_detected[proto_idx]++;
+                }
+                detected = true;
+            } else {
+                result->false_positives++;
+            }
+        }
+    }
+    if (config->cycles) result->cycles += config->cycles() - start_cycles;
+    result->elapsed_ns += config->clock() - start_ns;
+    result->edges += trace->count;
+}
+
+bool rf_bench_run(const RFBenchConfig* config, RFBenchCorpus corpus, RFBenchResult* result) {
+    static RFSimReceiver rx;
+    static BenchTx txs[256];
+    memset(result, 0, sizeof(RFBenchResult));
+    result->corpus = corpus;
+    result->stream = config->stream;
+    result->proto_count = corpus == RF_BENCH_NOISE ? 0 : config->proto_count;
+
+    const RFSimConfig sim_config = {
+        .seed = config->seed,
+        .jitter = corpus == RF_BENCH_JITTER ? config->jitter : 0,
+        .glitch_rate = corpus == RF_BENCH_JITTER ? config->glitch_rate : 0,
+        .drop_rate = corpus == RF_BENCH_JITTER ? config->drop_rate : 0,
+        .glitch_ticks = 30,
+    };
+    RFSim sim;
+    rf_sim_init(&sim, &sim_config);
+    BenchTrace trace = { .durations = config->trace, .max = config->trace_len };
+    rf_sim_rx_init(&rx, config->protos, config->proto_count, config->tolerance, config->separation_limit,
+        config->stream, 0);
+
+    if (corpus == RF_BENCH_NOISE) {
+        rf_sim_noise(&sim, config->noise_edges, 50, 2 * config->separation_limit, trace_edge, &trace);
+        if (trace.overflow) return false;
+        replay(config, &trace, NULL, 0, 0, &rx, result);
+        return true;
+    }
+
+    const uint16_t codes = config->codes_per_proto > 256 ? 256 : config->codes_per_proto;
+    result->codes_per_proto = codes;
+    for (uint8_t p = 0; p < config->proto_count; p++) {
+        RFSymbolTable table;
+        if (!rf_symbol_table_build(&config->protos[p], &table)) continue;
+
+        trace.count = 0;
+        for (uint16_t i = 0; i < codes; i++) {
+            // Common remote lengths, 24 to 40 bits
+            RFPulse pulses[RF_MAX_PULSES];
+            BenchTx* tx = &txs[i];
+            tx->bit_length = 24 + (i % 3) * 8;
+            const uint64_t value = ((uint64_t)rf_sim_rand(&sim) << 32) | rf_sim_rand(&sim);
+            rf_code_from_u64(&tx->code, value & ((1ULL << tx->bit_length) - 1));
+            const size_t count = rf_encode_code(&table, &tx->code, tx->bit_length, pulses, RF_MAX_PULSES);
+
+            rf_sim_play(&sim, pulses, count, config->repeat, trace_edge, &trace);
+            rf_sim_idle(&sim, 10 * config->separation_limit, trace_edge, &trace);
+            tx->end = trace.count;
+        }
+        if (trace.overflow) return false;
+
+        rf_sim_rx_init(&rx, config->protos, config->proto_count, config->tolerance, config->separation_limit,
+            config->stream, 0);
+        replay(config, &trace, txs, codes, p, &rx, result);
+        result->transmissions += codes;
+    }
+    return true;
+}
+
+void rf_bench_print(const RFBenchResult* r, FILE* out) {
+    const double seconds = r->elapsed_ns / 1e9;
+    fprintf(out, "{\"corpus\":\"%s\",\"mode\":\"%s\",\"edges\":%lu,\"transmissions\":%lu,\"detected\":%lu,"
+        "\"frames\":%lu,\"false_positives\":%lu,\"edges_per_s\":%.0f,\"frames_per_s\":%.0f,\"ns_per_edge\":%.1f,"
+        "\"cycles_per_edge\":%.1f,\"detect_rate\":%.4f,\"false_positive_rate\":%.4f,\"detect_by_proto\":[",
+        corpus_names[r->corpus], r->stream ? "stream" : "batch",
+        (unsigned long)r->edges, (unsigned long)r->transmissions, (unsigned long)r->detected,
+        (unsigned long)r->frames, (unsigned long)r->false_positives,
+        seconds > 0 ? r->edges / seconds : 0.0, seconds > 0 ? r->frames / seconds : 0.0,
+        r->edges ? (double)r->elapsed_ns / r->edges : 0.0, r->edges ? (double)r->cycles / r->edges : 0.0,
+        r->transmissions ? (double)r->detected / r->transmissions : 0.0,
+        r->frames ? (double)r->false_positives / r->frames : 0.0);
+    for (uint8_t p = 0; p < r->proto_count; p++)
+        fprintf(out, "%s%.4f", p ? "," : "", r->codes_per_proto ? (double)r->proto_detected[p] / r->codes_per_proto : 0.0);
+    fprintf(out, "]}\n");
+}
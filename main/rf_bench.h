@@ -0,0 +1,60 @@
+#ifndef RF_BENCH_H
+#define RF_BENCH_H
+
+/* Replays generated edge traces through the receive path and reports throughput and accuracy.
+Depends on rf_core.h and rf_sim.h only, the platform supplies the clocks */
+
+#include <stdio.h>
+#include "rf_sim.h"
+
+typedef enum {
+    RF_BENCH_CLEAN,
+    RF_BENCH_JITTER,
+    RF_BENCH_NOISE,
+    RF_BENCH_CORPUS_COUNT,
+} RFBenchCorpus;
+
+// Monotonic time in nanoseconds, and an optional CPU cycle counter (may wrap)
+typedef uint64_t (*RFBenchClock)(void);
+typedef uint32_t (*RFBenchCycles)(void);
+
+typedef struct {
+    const Protocol* protos;
+    uint8_t proto_count;
+    uint8_t tolerance;
+    uint32_t separation_limit;
+    bool stream;
+    uint16_t codes_per_proto;   // Transmissions per protocol in the clean and jitter corpora, at most 256
+    uint8_t repeat;             // Frames per transmission
+    uint8_t jitter;             // Jitter corpus impairments, see RFSimConfig
+    uint16_t glitch_rate, drop_rate;
+    uint32_t noise_edges;       // Length of the noise capture
+    uint32_t seed;
+    uint32_t* trace;            // Scratch for one protocol's trace, at least repeat * RF_MAX_PULSES per code
+    size_t trace_len;
+    RFBenchClock clock;
+    RFBenchCycles cycles;
+} RFBenchConfig;
+
+typedef struct {
+    RFBenchCorpus corpus;
+    bool stream;
+    uint32_t edges;
+    uint32_t transmissions, detected;     // Transmissions sent, and those decoded correctly at least once
+    uint32_t frames, false_positives;     // Frames decoded, and those not matching what was sent
+    uint8_t proto_count;
+    uint16_t codes_per_proto;
+    uint16_t proto_detected[RF_MAX_PROTOCOLS];   // Detected transmissions of every protocol, out of codes_per_proto
+    uint64_t elapsed_ns;
+    uint64_t cycles;
+} RFBenchResult;
+
+/* Returns false if the trace scratch is too small for one protocol's corpus.
+Not reentrant, the receiver model is static to keep it off the caller's stack */
+bool rf_bench_run(const RFBenchConfig* config, RFBenchCorpus corpus, RFBenchResult* result);
+
+/* One JSON object per line. Protocols whose sync gap is shorter than the separation limit
+(protocol 4 with the default limit) are never framed, their detect_by_proto entry stays at 0 */
+void rf_bench_print(const RFBenchResult* result, FILE* out);
+
+#endif // RF_BENCH_H
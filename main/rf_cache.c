@@ -0,0 +1,160 @@
+#include <string.h>
+#include "rf_core.h"
+
+static inline RFCacheHandle make_handle(const RFCodeCache* cache, uint8_t slot) {
+    return ((RFCacheHandle)cache->entries[slot].generation << 8) | (slot + 1);
+}
+
+static RFCacheEntry* RF_IRAM_ATTR entry_of(RFCodeCache* cache, RFCacheHandle handle) {
+    const uint32_t slot = (handle & 0xFF) - 1;
+    if (!handle || slot >= RF_CACHE_ENTRIES) return NULL;
+    RFCacheEntry* entry = &cache->entries[slot];
+    if (!entry->ready || entry->generation != (uint16_t)(handle >> 8)) return NULL;
+    return entry;
+}
+
+// Gap in front of the live entry at pos in arena order, pos == live is the tail of the arena
+static inline uint32_t gap_start(const RFCodeCache* cache, uint8_t pos) {
+    if (!pos) return 0;
+    const RFCacheEntry* prev = &cache->entries[cache->order[pos - 1]];
+    return prev->offset + prev->count;
+}
+
+static inline uint32_t gap_size(const RFCodeCache* cache, uint8_t pos) {
+    const uint32_t end = pos < cache->live ? cache->entries[cache->order[pos]].offset : cache->arena_size;
+    return end - gap_start(cache, pos);
+}
+
+static void release(RFCodeCache* cache, uint8_t pos) {
+    RFCacheEntry* entry = &cache->entries[cache->order[pos]];
+    memmove(&cache->order[pos], &cache->order[pos + 1], cache->live - pos - 1);
+    cache->live--;
+    entry->used = false;
+    entry->ready = false;
+    entry->generation++;
+    cache->stats.entries--;
+    cache->stats.arena_used -= entry->count;
+}
+
+// Position of the first gap of count pulses in arena order, -1 if the arena has none
+static int32_t find_gap(const RFCodeCache* cache, uint16_t count) {
+    for (uint8_t pos = 0; pos <= cache->live; pos++)
+        if (gap_size(cache, pos) >= count) return pos;
+    return -1;
+}
+
+// Position the evicted entry left, its gap now merged with the ones around it. -1 if all are pinned
+static int32_t evict_lru(RFCodeCache* cache) {
+    int32_t victim = -1;
+    for (uint8_t pos = 0; pos < cache->live; pos++) {
+        const RFCacheEntry* entry = &cache->entries[cache->order[pos]];
+        if (!entry->pins && (victim < 0 || (int32_t)(entry->last_use - cache->entries[cache->order[victim]].last_use) < 0))
+            victim = pos;
+    }
+    if (victim < 0) return -1;
+    release(cache, victim);
+    cache->stats.evictions++;
+    return victim;
+}
+
+void rf_cache_init(RFCodeCache* cache, RFPulse* arena, uint32_t arena_size) {
+    memset(cache, 0, sizeof(RFCodeCache));
+    cache->arena = arena;
+    cache->arena_size = arena_size > UINT16_MAX ? UINT16_MAX : arena_size;
+}
+
+RFCacheHandle rf_cache_find(RFCodeCache* cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length) {
+    for (uint8_t i = 0; i < RF_CACHE_ENTRIES; i++) {
+        RFCacheEntry* entry = &cache->entries[i];
+        if (entry->ready && entry->proto_idx == proto_idx && entry->bit_length == bit_length && rf_code_equal(&entry->code, code)) {
+            entry->last_use = ++cache->clock;
+            return make_handle(cache, i);
+        }
+    }
+    return 0;
+}
+
+RFCacheHandle rf_cache_reserve(RFCodeCache* cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+        uint16_t count, RFPulse** pulses) {
+    *pulses = NULL;
+    if (!code || bit_length > RF_MAX_CODE_BITS) return 0;
+    const RFCacheHandle found = rf_cache_find(cache, proto_idx, code, bit_length);
+    if (found) {
+        cache->stats.hits++;
+        return found;
+    }
+    cache->stats.misses++;
+
+    // Same length rf_encode_code produces: a pair per bit and the sync pair
+    if (count != (uint16_t)bit_length * 2 + 2) {
+        cache->stats.failures++;
+        return 0;
+    }
+    // Every eviction only merges the gaps next to it, so only that one is checked again
+    int32_t pos = find_gap(cache, count);
+    while (pos < 0 || cache->live == RF_CACHE_ENTRIES) {
+        const int32_t freed = evict_lru(cache);
+        if (freed < 0) {
+            cache->stats.failures++;
+            return 0;
+        }
+        if (pos > freed) pos--;
+        else if (pos < 0 && gap_size(cache, freed) >= count) pos = freed;
+    }
+
+    uint8_t slot = 0;
+    while (cache->entries[slot].used) slot++;
+    RFCacheEntry* entry = &cache->entries[slot];
+    entry->offset = gap_start(cache, pos);
+    memmove(&cache->order[pos + 1], &cache->order[pos], cache->live - pos);
+    cache->order[pos] = slot;
+    cache->live++;
+
+    entry->code = *code;
+    entry->last_use = ++cache->clock;
+    entry->count = count;
+    entry->proto_idx = proto_idx;
+    entry->bit_length = bit_length;
+    entry->pins = 1;
+    entry->used = true;
+    entry->ready = false;
+    cache->stats.entries++;
+    cache->stats.arena_used += count;
+    *pulses = cache->arena + entry->offset;
+    return make_handle(cache, slot);
+}
+
+void rf_cache_commit(RFCodeCache* cache, RFCacheHandle handle) {
+    RFCacheEntry* entry = &cache->entries[(handle & 0xFF) - 1];
+    entry->ready = true;
+    entry->pins--;
+}
+
+const RFCacheEntry* RF_IRAM_ATTR rf_cache_get(RFCodeCache* cache, RFCacheHandle handle) {
+    RFCacheEntry* entry = entry_of(cache, handle);
+    if (entry) entry->last_use = ++cache->clock;
+    return entry;
+}
+
+bool rf_cache_pin(RFCodeCache* cache, RFCacheHandle handle) {
+    RFCacheEntry* entry = entry_of(cache, handle);
+    if (!entry || entry->pins == UINT8_MAX) return false;
+    entry->pins++;
+    return true;
+}
+
+bool RF_IRAM_ATTR rf_cache_unpin(RFCodeCache* cache, RFCacheHandle handle) {
+    RFCacheEntry* entry = entry_of(cache, handle);
+    if (!entry || !entry->pins) return false;
+    entry->pins--;
+    return true;
+}
+
+bool rf_cache_remove(RFCodeCache* cache, RFCacheHandle handle) {
+    RFCacheEntry* entry = entry_of(cache, handle);
+    if (!entry || entry->pins) return false;
+    uint8_t pos = 0;
+    while (cache->order[pos] != entry - cache->entries) pos++;
+    release(cache, pos);
+    return true;
+}
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "rf_core.h"
+
+static inline uint32_t diff(uint32_t a, uint32_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+/* Every data pulse is assigned the nearest of the protocol's pulse multiples at the current unit,
+the unit is then re-estimated as total duration over total multiples. Pulses too far from any
+multiple are left out, so a single distorted pulse (sync included) barely moves the estimate */
+uint32_t rf_estimate_unit(const Protocol* proto, const uint32_t* timings, uint32_t edge_count) {
+    const uint8_t multiples[4] = { proto->zero.high, proto->zero.low, proto->one.high, proto->one.low };
+    uint32_t unit = timings[0] / (proto->sync_factor.low > proto->sync_factor.high
+        ? proto->sync_factor.low : proto->sync_factor.high);
+    const uint32_t first_data_timing = proto->inverted ? 2 : 1;
+    if (edge_count < RF_MIN_FRAME_EDGES || unit == 0) return unit;
+
+    for (uint8_t pass = 0; pass < RF_CALIB_PASSES; pass++) {
+        uint64_t total = 0;
+        uint32_t units = 0;
+        for (uint32_t i = first_data_timing; i < edge_count - 1; i++) {
+            uint32_t best = UINT32_MAX, best_multiple = 0;
+            for (uint8_t m = 0; m < 4; m++) {
+                const uint32_t d = diff(timings[i], unit * multiples[m]);
+                if (d < best) {
+                    best = d;
+                    best_multiple = multiples[m];
+                }
+            }
+            if (best * 2 > unit) continue;
+            total += timings[i];
+            units += best_multiple;
+        }
+        if (units == 0) break;
+        unit = total / units;
+    }
+    return unit;
+}
+
+void rf_calib_reset(RFCalibration* calib, uint8_t min_tolerance) {
+    memset(calib, 0, sizeof(RFCalibration));
+    calib->min_tolerance = min_tolerance;
+}
+
+const RFTimingProfile* rf_calib_lookup(const RFCalibration* calib, uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    for (uint8_t i = 0; i < calib->count; i++) {
+        const RFTimingProfile* p = &calib->profiles[i];
+        if (p->proto == proto && p->bit_length == bit_length && rf_code_equal(&p->code, code)) return p;
+    }
+    return NULL;
+}
+
+static void calib_learn(RFCalibration* calib, const RFRecvFrame* frame, uint32_t max_dev, uint8_t tolerance) {
+    RFTimingProfile* p = (RFTimingProfile*)rf_calib_lookup(calib, frame->proto, &frame->code, frame->bit_length);
+    if (!p) {
+        /* Full table: the least recently seen profile makes room. Fewest hits would always pick the
+        newest profile, so a new remote could never stay long enough to build one */
+        if (calib->count < RF_CALIB_PROFILES) {
+            p = &calib->profiles[calib->count++];
+        } else {
+            p = &calib->profiles[0];
+            for (uint8_t i = 1; i < RF_CALIB_PROFILES; i++)
+                if ((int32_t)(calib->profiles[i].last_use - p->last_use) < 0) p = &calib->profiles[i];
+        }
+        p->proto = frame->proto;
+        p->bit_length = frame->bit_length;
+        p->code = frame->code;
+        p->unit = frame->delay;
+        p->max_dev = max_dev;
+        p->hits = 0;
+        p->tolerance = tolerance;
+    }
+    p->last_use = ++calib->clock;
+
+    // Exponential averages, 1/8 weight for the new frame
+    p->unit = (p->unit * 7 + frame->delay) / 8;
+    p->max_dev = (p->max_dev * 7 + max_dev) / 8;
+    // A near miss widens the profile at once, the remote's timing has drifted or got noisier
+    if (max_dev > p->tolerance && max_dev > p->max_dev) p->max_dev = max_dev;
+    if (p->hits < UINT16_MAX) p->hits++;
+
+    // Known remotes are held to their own spread plus margin
+    uint32_t narrowed = p->max_dev * 3 / 2 + RF_CALIB_MARGIN;
+    if (narrowed < calib->min_tolerance) narrowed = calib->min_tolerance;
+    if (narrowed > tolerance) narrowed = tolerance;
+    p->tolerance = p->hits >= RF_CALIB_MIN_HITS ? narrowed : tolerance;
+}
+
+bool rf_decode_calibrated(RFCalibration* calib, const RFProtoIndex* index, const Protocol* protos,
+        const uint32_t* timings, uint32_t edge_count, uint8_t tolerance, RFRecvFrame* frame, uint32_t* rejected) {
+    RFCandidate candidates[RF_MAX_CANDIDATES];
+    RFRecvFrame near;
+    uint32_t max_dev, near_dev = 0;
+    bool has_near = false;
+    if (rejected) *rejected = 0;
+
+    const uint8_t count = rf_classify(index, timings, edge_count, candidates, RF_MAX_CANDIDATES);
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t proto = candidates[i].proto;
+        const uint32_t unit = rf_estimate_unit(&protos[proto], timings, edge_count);
+        bool decoded = rf_decode_timings_unit(&protos[proto], timings, edge_count, unit, tolerance, frame, &max_dev);
+
+        if (decoded) {
+            // A known remote outside its narrowed profile is a near miss, kept in case no other candidate fits
+            frame->proto = proto;
+            const RFTimingProfile* p = rf_calib_lookup(calib, proto, &frame->code, frame->bit_length);
+            if (p && p->hits >= RF_CALIB_MIN_HITS && max_dev > p->tolerance) {
+                if (!has_near) {
+                    near = *frame;
+                    near_dev = max_dev;
+                    has_near = true;
+                }
+                if (rejected) *rejected |= 1UL << proto;
+                continue;
+            }
+        } else {
+            // The learned units of known remotes may still fit where the estimate did not
+            for (uint8_t j = 0; j < calib->count && !decoded; j++) {
+                const RFTimingProfile* p = &calib->profiles[j];
+                if (p->proto != proto || p->hits < RF_CALIB_MIN_HITS) continue;
+                decoded = rf_decode_timings_unit(&protos[proto], timings, edge_count, p->unit, tolerance, frame, &max_dev) &&
+                    frame->bit_length == p->bit_length && rf_code_equal(&frame->code, &p->code);
+            }
+        }
+
+        if (decoded) {
+            frame->proto = proto;
+            frame->candidates = count;
+            calib_learn(calib, frame, max_dev, tolerance);
+            return true;
+        }
+        if (rejected) *rejected |= 1UL << proto;
+    }
+
+    // Nothing fits better, so the near miss is taken at the protocol's own tolerance and widens its profile
+    if (has_near) {
+        *frame = near;
+        frame->candidates = count;
+        if (rejected) *rejected &= ~(1UL << near.proto);
+        calib_learn(calib, frame, near_dev, tolerance);
+        return true;
+    }
+    return false;
+}
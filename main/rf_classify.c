@@ -0,0 +1,104 @@
+#include "rf_core.h"
+
+static inline uint32_t deviation(uint32_t observed, uint32_t expected) {
+    const uint32_t d = observed > expected ? observed - expected : expected - observed;
+    return expected ? (uint32_t)((uint64_t)d * 100 / expected) : UINT32_MAX;
+}
+
+static void insert_sorted(RFRatioEntry* entries, uint8_t* count, uint32_t ratio, uint8_t proto) {
+    uint8_t i = *count;
+    while (i > 0 && entries[i - 1].ratio > ratio) {
+        entries[i] = entries[i - 1];
+        i--;
+    }
+    entries[i].ratio = ratio;
+    entries[i].proto = proto;
+    (*count)++;
+}
+
+void rf_proto_index_build(RFProtoIndex* index, const Protocol* protos, uint8_t proto_count) {
+    rf_proto_index_build_mask(index, protos, proto_count, UINT32_MAX);
+}
+
+void rf_proto_index_build_mask(RFProtoIndex* index, const Protocol* protos, uint8_t proto_count, uint32_t enabled) {
+    index->normal_count = 0;
+    index->inverted_count = 0;
+    if (proto_count > RF_MAX_PROTOCOLS) proto_count = RF_MAX_PROTOCOLS;
+
+    for (uint8_t i = 0; i < proto_count; i++) {
+        if (!(enabled & (1UL << i))) continue;
+        const Protocol* p = &protos[i];
+        const uint8_t sync_long = p->sync_factor.high > p->sync_factor.low ? p->sync_factor.high : p->sync_factor.low;
+        const uint8_t sync_short = p->sync_factor.high > p->sync_factor.low ? p->sync_factor.low : p->sync_factor.high;
+        const uint32_t sync_ratio = RF_RATIO(sync_long, sync_short);
+
+        if (p->inverted) insert_sorted(index->inverted, &index->inverted_count, sync_ratio, i);
+        else insert_sorted(index->normal, &index->normal_count, sync_ratio, i);
+
+        index->zero_ratio[i] = RF_RATIO(p->zero.high, p->zero.low);
+        index->one_ratio[i] = RF_RATIO(p->one.high, p->one.low);
+    }
+}
+
+// Mean deviation of the first data pairs from the closest of the protocol's two bit ratios
+static uint32_t data_deviation(const RFProtoIndex* index, uint8_t proto, const uint32_t* timings,
+        uint32_t first, uint32_t end) {
+    uint32_t total = 0, pairs = 0;
+    for (uint32_t i = first; i + 1 < end && pairs < RF_CLASSIFY_PAIRS; i += 2, pairs++) {
+        const uint32_t observed = RF_RATIO(timings[i], timings[i + 1]);
+        const uint32_t dev_zero = deviation(observed, index->zero_ratio[proto]);
+        const uint32_t dev_one = deviation(observed, index->one_ratio[proto]);
+        total += dev_zero < dev_one ? dev_zero : dev_one;
+    }
+    return pairs ? total / pairs : UINT32_MAX;
+}
+
+static void add_candidate(RFCandidate* candidates, uint8_t* count, uint8_t max, uint8_t proto, uint32_t score) {
+    if (score > UINT8_MAX) score = UINT8_MAX;
+    uint8_t i = *count < max ? *count : max;
+    if (i == max && (i == 0 || candidates[i - 1].score <= score)) return;
+    if (i == max) i--;
+    while (i > 0 && candidates[i - 1].score > score) {
+        candidates[i] = candidates[i - 1];
+        i--;
+    }
+    candidates[i].proto = proto;
+    candidates[i].score = score;
+    if (*count < max) (*count)++;
+}
+
+static void scan(const RFProtoIndex* index, const RFRatioEntry* entries, uint8_t entry_count, bool inverted,
+        const uint32_t* timings, uint32_t edge_count, RFCandidate* candidates, uint8_t* count, uint8_t max) {
+    const uint32_t sync_short = inverted ? timings[1] : timings[edge_count - 1];
+    const uint32_t observed = RF_RATIO(timings[0], sync_short);
+    const uint32_t lo = (uint32_t)((uint64_t)observed * 100 / (100 + RF_CLASSIFY_TOLERANCE));
+    const uint32_t hi = (uint32_t)((uint64_t)observed * 100 / (100 - RF_CLASSIFY_TOLERANCE));
+
+    // Binary search for the first signature inside the ratio window
+    uint8_t left = 0, right = entry_count;
+    while (left < right) {
+        const uint8_t mid = (left + right) / 2;
+        if (entries[mid].ratio < lo) left = mid + 1;
+        else right = mid;
+    }
+
+    const uint32_t first_data = inverted ? 2 : 1;
+    const uint32_t data_end = inverted ? edge_count : edge_count - 1;
+    for (uint8_t i = left; i < entry_count && entries[i].ratio <= hi; i++) {
+        const uint8_t proto = entries[i].proto;
+        const uint32_t sync_dev = deviation(observed, entries[i].ratio);
+        const uint32_t data_dev = data_deviation(index, proto, timings, first_data, data_end);
+        if (data_dev > RF_CLASSIFY_TOLERANCE) continue;
+        add_candidate(candidates, count, max, proto, (sync_dev + data_dev) / 2);
+    }
+}
+
+uint8_t rf_classify(const RFProtoIndex* index, const uint32_t* timings, uint32_t edge_count,
+        RFCandidate* candidates, uint8_t max_candidates) {
+    uint8_t count = 0;
+    if (edge_count < 4 || max_candidates == 0) return 0;
+
+    scan(index, index->normal, index->normal_count, false, timings, edge_count, candidates, &count, max_candidates);
+    scan(index, index->inverted, index->inverted_count, true, timings, edge_count, candidates, &count, max_candidates);
+    return count;
+}
@@ -0,0 +1,53 @@
+#include <string.h>
+#include "rf_core.h"
+
+void RF_IRAM_ATTR rf_accum_finish(const RFBitAccum* acc, RFCode* code) {
+    memset(code, 0, sizeof(RFCode));
+
+    // acc->words hold whole 32-bit chunks most significant first, acc->cur the trailing rem bits
+    const uint8_t full = acc->bits >> 5;
+    const uint8_t rem = acc->bits & 31;
+    if (rem == 0) {
+        for (uint8_t j = 0; j < full; j++)
+            code->words[j] = acc->words[full - 1 - j];
+        return;
+    }
+
+    code->words[0] = acc->cur;
+    for (uint8_t j = 0; j < full; j++) {
+        const uint32_t chunk = acc->words[full - 1 - j];
+        code->words[j] |= chunk << rem;
+        code->words[j + 1] = chunk >> (32 - rem);
+    }
+}
+
+void rf_code_from_u64(RFCode* code, uint64_t value) {
+    memset(code, 0, sizeof(RFCode));
+    code->words[0] = (uint32_t)value;
+    if (RF_CODE_WORDS > 1) code->words[1] = (uint32_t)(value >> 32);
+}
+
+bool rf_decode_code(const RFCode* code, uint8_t bit_length, RFRecvData* data) {
+    if (bit_length > RF_MAX_CODE_BITS) bit_length = RF_MAX_CODE_BITS;
+    data->code = *code;
+    data->bit_length = bit_length;
+
+    for (uint8_t j = 0; j < bit_length; j++)
+        data->binary[j] = '0' + rf_code_bit(code, bit_length - 1 - j);
+    data->binary[bit_length] = '\0';
+
+    // Pairs from the most significant bit: 00 = '0', 11 = '1', 01 = 'F', a trailing odd bit is ignored
+    static const char pair_symbol[4] = { '0', 'F', '\0', '1' };
+    const uint8_t symbols = bit_length / 2;
+    for (uint8_t j = 0; j < symbols; j++) {
+        const uint8_t bit = bit_length - 1 - j * 2;
+        const uint8_t pair = (rf_code_bit(code, bit) << 1) | rf_code_bit(code, bit - 1);
+        data->tri_state[j] = pair_symbol[pair];
+        if (!data->tri_state[j]) {
+            data->tri_state[0] = '\0';
+            return false;
+        }
+    }
+    data->tri_state[symbols] = '\0';
+    return true;
+}
@@ -5,17 +5,53 @@
 #include <inttypes.h>
 #include "esp_err.h"
 #include "driver/gpio.h"
+#include "driver/gpio_filter.h"
+#include "soc/soc_caps.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "driver/gptimer.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_rx.h"
+#include "esp_partition.h"
+#include "rf_core.h"
 
 #define TAG "RF_TEST"
 
 #define DEFAULT_RESOLUTION 1000000
-#define MAX_EDGES 67
 #define RECV_TOLERANCE 60
 #define SEPARATION_LIMIT 4300
 #define PROTO_COUNT 12
+#define RF_FRAME_POOL_SIZE 4
+#define RF_DECODER_TASK_STACK 4096
+#define RF_DECODER_TASK_PRIO 10
+#define RF_DECODER_TASK_CORE tskNO_AFFINITY
+#define RF_MAX_RECEIVERS 4
+#define RF_RECV_RATE_WINDOW 10000         // us
+#define RF_RECV_MAX_EDGE_RATE 20000       // edges per second before the receiver mutes itself
+#define RF_RECV_MUTE_US 50000
+
+// Code registry defaults: repeats closer than the hold-off are one press, held after RF_REGISTRY_HELD_US
+#define RF_REGISTRY_HOLDOFF_US 150000
+#define RF_REGISTRY_HELD_US 600000
+
+// Full duplex: edges this long after our own transmission are still taken as its echo
+#define RF_ECHO_GUARD_US 2000
+
+#define RF_TX_QUEUE_SIZE 32
+#define RF_TX_DEFAULT_GAP_US 10000
+#define RF_RECV_FLEX_FILTER_MAX_NS 1000
+#define RF_RMT_TX_MEM_SYMBOLS 48
+#define RF_RMT_TX_QUEUE_DEPTH RC_SWITCH_REPEAT_COUNT
+#define RF_RMT_RX_MEM_SYMBOLS 64
+#define RF_RMT_RX_BUFFER_SYMBOLS 1024
+#define RF_RMT_RX_IDLE_US 30000           // Upper bound of the idle time that ends a capture
+#define RF_RMT_RX_MIN_NS 3000             // Hardware filter, pulses shorter than this are ignored
+#define RF_RMT_RX_TOLERANCE 30
+
+// Lowest tolerance calibration narrows a known remote to, in percent
+#define RF_CALIB_MIN_TOLERANCE 15
 
 enum {
     RC_SWITCH_1_PULSE_LEN = 350,
@@ -30,24 +66,11 @@ enum {
     FAST_REPEAT_COUNT = 4,
 };
 
-typedef struct {
-    uint8_t high;
-    uint8_t low;
-} RFTicks;
-
-typedef struct {
-    uint16_t pulse_length;
-    RFTicks sync_factor;
-    RFTicks zero;
-    RFTicks one;
-    bool inverted;
-} Protocol;
-
 static const DRAM_ATTR Protocol proto[] = {
     { FAST_PULSE_LEN, {  1, 31 }, {  1,  3 }, {  3,  1 }, false },    // protocol 1
     { 650, {  1, 10 }, {  1,  2 }, {  2,  1 }, false },    // protocol 2
     { 100, { 30, 71 }, {  4, 11 }, {  9,  6 }, false },    // protocol 3
-    { 380, {  1,  6 }, {  1,  3 }, {  3,  1 }, false },    // protocol 4
+    { 380, {  1,  6 }, {  1,  3 }, {  3,  1 }, false },    // protocol 4, transmit only: its 2280 us sync is under SEPARATION_LIMIT
     { 500, {  6, 14 }, {  1,  2 }, {  2,  1 }, false },    // protocol 5
     { 450, { 23,  1 }, {  1,  2 }, {  2,  1 }, true },     // protocol 6 (HT6P20B)
     { 150, {  2, 62 }, {  1,  6 }, {  6,  1 }, false },    // protocol 7 (HS2303-PT, i. e. used in AUKEY Remote)
@@ -58,64 +81,414 @@ static const DRAM_ATTR Protocol proto[] = {
     { 320, { 36,  1 }, {  1,  2 }, {  2,  1 }, true }      // protocol 12 (SM5212)
 };
 
+typedef enum {
+    RF_TX_BACKEND_GPTIMER,
+    RF_TX_BACKEND_RMT,
+} RFTxBackend;
+
+typedef enum {
+    RF_DECODE_BATCH,
+    RF_DECODE_STREAM,
+} RFDecodeMode;
+
+typedef enum {
+    RF_RX_BACKEND_GPIO,   // Edge interrupt timestamped with esp_timer
+    RF_RX_BACKEND_RMT,    // RMT RX channel, whole bursts timestamped in hardware
+} RFRxBackend;
+
+enum {
+    RF_DECODE_JOB_FRAME,  // Timing frame captured by the edge ISR
+    RF_DECODE_JOB_RMT,    // Symbol buffer captured by the RMT RX channel
+};
+
+typedef struct {
+    uint32_t timings[MAX_EDGES];
+    uint32_t edge_count;
+    int64_t timestamp;
+} RFTimingFrame;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t overflows;
+    uint32_t pool_overflows;
+    uint32_t isr_max_cycles;
+    uint32_t isr_calls;
+    uint64_t isr_cycles;
+} RFRecvStats;
+
+typedef struct {
+    uint8_t id;
+    bool init;
+    gpio_num_t rx_gpio, rx_gpio_state;
+
+    // Reception configuration
+    uint32_t separation_limit;
+    uint8_t recv_tolerance;
+    RFDecodeMode recv_mode;
+    uint8_t recv_confirm;
+    RFStreamDecoder recv_stream;
+    RFProtoIndex recv_index;
+    uint32_t recv_protocols;    // Enabled protocol mask, bit n = table index n
+    bool recv_calibrate;
+    RFCalibration recv_calib;
+    RFRegistry* recv_registry;
+
+    // Sniffer, raw edges as trace records for capture and replay
+    RFTraceRing recv_sniff;
+    uint8_t recv_level;     // Line level during the pulse the next edge ends
+
+    /* Echo gate, edges timed inside [start, end) are our own transmission. Low 32 bits
+    of esp_timer time so the ISR reads them atomically */
+    volatile uint32_t recv_echo_start, recv_echo_end;
+    bool recv_echo_resync;
+
+    // Receive front-end, drops glitches and mutes the pin in noise storms
+    uint32_t recv_min_pulse, recv_max_edges, recv_mute_us;
+    RFGlitchFilter recv_glitch;
+    RFRateLimit recv_limit;
+    gpio_glitch_filter_handle_t recv_filter;
+    esp_timer_handle_t recv_rearm;
+    volatile bool recv_muted;
+
+    /* RMT capture backend. The driver captures into rmt_rx_dma, the done callback copies each chunk
+    into a free job buffer for the decoder task and the driver carries on at once */
+    RFRxBackend recv_backend;
+    rmt_channel_handle_t rx_chan;
+    rmt_receive_config_t rmt_rx_config;
+    uint32_t rmt_rx_idle_us;
+    rmt_symbol_word_t* rmt_rx_dma;
+    rmt_symbol_word_t* rmt_rx_buf[2];
+    size_t rmt_rx_count[2];
+    int64_t rmt_rx_end[2];
+    uint8_t rmt_rx_flags[2];
+    uint32_t rmt_rx_busy;
+    bool rmt_rx_cont, rmt_rx_after_idle;    // Callback side, how the next chunk follows the last one posted
+    int64_t rmt_rx_time;                    // Decoder side, end of the last edge fed
+    uint32_t rmt_rx_last_gap;
+    bool rmt_rx_skip;                       // Rest of a capture dropped by the rate limit
+
+    // Edge ISR state
+    RFFramer recv_framer;
+    int64_t last_time;
+
+    // Timing frames captured by the ISR, decoded by the shared decoder task
+    RFTimingFrame recv_pool[RF_FRAME_POOL_SIZE];
+    uint8_t recv_fill;
+    uint32_t recv_pool_busy, recv_pool_overflows, recv_isr_max_cycles, recv_isr_calls;
+    uint64_t recv_isr_cycles;
+
+    // Decoded output
+    uint32_t recv_frames;
+    RFRecvRing recv_ring;
+    TaskHandle_t rf_recv_handle;
+} RFReceiver;
+
+// Called from the transmit ISR once a queued item is sent (ESP_OK), or from rf_tx_flush (ESP_ERR_INVALID_STATE)
+typedef void (*RFTxCallback)(uint32_t id, esp_err_t result, void* arg);
+
+typedef struct {
+    uint8_t priority;       // Higher goes first, equal priorities keep their order
+    uint8_t repeat;         // 0 = the transmitter's repeat count
+    uint32_t gap_us;        // Line kept low after the item before the next one starts, 0 = RF_TX_DEFAULT_GAP_US
+    RFTxCallback callback;
+    void* arg;
+} RFTxOptions;
+
+typedef struct {
+    RFCode code;
+    const RFSymbolTable* table;
+    RFCacheHandle handle;   // Prepared code pinned while queued, 0 = encoded when it starts
+    RFTxCallback callback;
+    void* arg;
+    uint32_t id, seq, gap_us;
+    uint8_t bit_length, proto_idx, priority, repeat;
+} RFTxItem;
+
 typedef struct {
-    uint8_t level;
-    uint32_t pulse_length;
-} RFPulse;
+    uint32_t depth, max_depth;
+    uint32_t enqueued, coalesced, completed, rejected;
+} RFTxQueueStats;
 
+// Prepared-code cache shared by transmitters, the arena is provided by the caller
 typedef struct {
-    uint32_t original_value;
-    char* tri_state;
-    char* binary;
-} RFRecvData;
+    RFCodeCache cache;
+    portMUX_TYPE lock;
+} RFTxCache;
 
 typedef struct {
     // Pulse data for transmission
-    RFPulse* pulses;
+    RFPulse pulses[RF_MAX_PULSES] __attribute__((aligned(4)));
     size_t pulse_count;
-    uint8_t pulse_index;
+    RFSymbolTable tx_table;
+    uint16_t pulse_index;
+    // Configured train set aside while rf_send_code / rf_send_tristate send another one
+    RFPulse saved_pulses[RF_MAX_PULSES] __attribute__((aligned(4)));
+    size_t saved_count;
+    bool saved;
 
     // Transmission state
     uint8_t current_rep;
     uint8_t repeat_count;
+    uint8_t tx_repeats;     // Repeats of the train being sent
+    bool tx_in_gap;         // Waiting out the gap before the next queued item
+    int64_t tx_start;
 
-    // Reception configuration
-    uint32_t recv_value, recv_bit_length, recv_delay, separation_limit;
-    uint8_t recv_proto, recv_tolerance;
-    uint32_t recv_timings[MAX_EDGES];
+    // Absolute edge schedule of the train being sent, repeats run on without stopping the timer
+    RFTxSchedule tx_schedule;
+    uint64_t tx_base;       // Timer count the schedule started at
+    RFPulse tx_final_sync[2];
+    bool tx_final;
+
+    // Transmit queue, drained from the timer ISR
+    RFTxItem tx_queue[RF_TX_QUEUE_SIZE];
+    uint8_t tx_queue_count;
+    RFTxItem tx_current;
+    bool tx_current_valid;
+    uint32_t tx_seq, tx_next_id;
+    RFTxQueueStats tx_stats;
+    portMUX_TYPE tx_lock;
+    RFTxCache* tx_cache;
 
     // GPIO configuration
     bool tx_active, init;
     gpio_num_t tx_gpio;
-    gpio_num_t rx_gpio, rx_gpio_state;
+
+    // Receiver sharing the antenna, paused during transmission or gated in duplex mode
+    RFReceiver* rx;
+    bool tx_duplex;
 
     Protocol* proto;
-    TaskHandle_t rf_trans_handle, rf_recv_handle;
+    TaskHandle_t rf_trans_handle;
     gptimer_handle_t timer;
+
+    // RMT transmission engine
+    RFTxBackend tx_backend;
+    rmt_channel_handle_t tx_chan;
+    rmt_encoder_handle_t tx_encoder;
+    volatile uint8_t rmt_pending;
 } RFTransmitter;
 
+// Lead between queuing a train on the shared scheduler and its first edge, in timer ticks
+#define RF_SCHED_LEAD_TICKS 50
+
+typedef struct {
+    RFPulse pulses[RF_MAX_PULSES];
+    gpio_num_t gpio;
+    uint64_t pin_mask;      // Bit of gpio in the output set/clear registers, OUT1 from bit 32
+    RFTxCallback callback;
+    void* arg;
+} RFSchedTxChannel;
+
+// One GPTimer driving up to RF_SCHED_CHANNELS transmit pins concurrently from a merged edge schedule
+typedef struct {
+    RFSched sched;
+    RFSchedTxChannel channels[RF_SCHED_CHANNELS];
+    uint8_t channel_count;
+    portMUX_TYPE lock;
+    gptimer_handle_t timer;
+} RFTxScheduler;
+
 esp_err_t rf_init(gpio_num_t tx_gpio, int8_t repeat_count, Protocol* tx_proto, RFTransmitter* rf_rmt);
 
 esp_err_t rf_deinit(RFTransmitter* rf_rmt);
 
 esp_err_t translate_tristate(const char* data, RFTransmitter* rf_rmt);
 
+esp_err_t translate_binary(const RFCode* code, uint8_t bit_length, RFTransmitter* rf_rmt);
+
 esp_err_t rf_send(RFTransmitter* rf_rmt);
 
+// Start the loaded pulse train with tx_repeats repeats, no state checks
+esp_err_t rf_send_start(RFTransmitter* rf_rmt);
+
+// Build tx_schedule for the loaded pulse train and tx_repeats
+void rf_tx_schedule_load(RFTransmitter* rf_rmt);
+
+// Set the configured pulse train aside before a one-off train overwrites it, and put it back
+void rf_tx_pulses_save(RFTransmitter* rf_rmt);
+void rf_tx_pulses_restore(RFTransmitter* rf_rmt);
+
+/* End the final repeat of every GPTimer send with this sync pair instead of the protocol's, NULL restores it.
+The RMT backend loops the train in hardware and ignores it */
+esp_err_t rf_set_final_sync(RFTransmitter* rf_rmt, const RFPulse* sync);
+
+/* Open the receiver's echo window for the whole loaded tx_schedule, starting lead_us from now.
+rf_tx_schedule_load comes first */
+void rf_tx_echo_begin(RFTransmitter* rf_rmt, uint32_t lead_us);
+
+/* Queue a code for transmission, started right away if the transmitter is idle. A pending item with
+the same protocol, code and length absorbs the new one (highest priority and repeat win) unless both
+carry different callbacks. The GPTimer backend only, queued items follow each other from the timer ISR */
+esp_err_t rf_tx_enqueue(RFTransmitter* rf_rmt, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+    const RFTxOptions* options, uint32_t* id);
+
+// Drop every pending item, their callbacks run from the caller with ESP_ERR_INVALID_STATE
+esp_err_t rf_tx_flush(RFTransmitter* rf_rmt);
+
+esp_err_t rf_tx_get_stats(RFTransmitter* rf_rmt, RFTxQueueStats* stats);
+
+// Timer ISR: finish the current item and load the next one. False when the queue ran dry
+bool rf_tx_queue_advance(RFTransmitter* rf_rmt, uint32_t* gap_us);
+
+esp_err_t rf_tx_cache_init(RFTxCache* rf_cache, RFPulse* arena, size_t arena_pulses);
+
+/* Encode a code once into the cache, or find it there, e.g. to pre-warm a device catalogue at boot.
+ESP_ERR_NO_MEM when the arena is full of pinned entries */
+esp_err_t rf_tx_prepare(RFTxCache* rf_cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+    RFCacheHandle* handle);
+
+// Pinned codes survive eviction until unpinned
+esp_err_t rf_tx_cache_pin(RFTxCache* rf_cache, RFCacheHandle handle, bool pin);
+
+esp_err_t rf_tx_cache_get_stats(RFTxCache* rf_cache, RFCacheStats* stats);
+
+// Cache the transmitter's prepared sends come from, only while nothing prepared is queued
+esp_err_t rf_set_cache(RFTransmitter* rf_rmt, RFTxCache* rf_cache);
+
+// Send a prepared code right away, ESP_ERR_NOT_FOUND once it was evicted
+esp_err_t rf_send_prepared(RFTransmitter* rf_rmt, RFCacheHandle handle);
+
+// Same as rf_tx_enqueue for a prepared code, which stays pinned until it is sent or flushed
+esp_err_t rf_tx_enqueue_prepared(RFTransmitter* rf_rmt, RFCacheHandle handle, const RFTxOptions* options, uint32_t* id);
+
+// Encode the low bit_length bits of value with protocol proto_idx (index into the protocol table) and send them.
+// The train set by translate_tristate / translate_binary is kept and sent again by the next rf_send
+esp_err_t rf_send_code(RFTransmitter* rf_rmt, uint64_t value, uint8_t bit_length, uint8_t proto_idx);
+
+// Same as rf_send_code for symbol_count tri-state symbols packed 2 bits each (00 = '0', 11 = '1', 01 = 'F')
+esp_err_t rf_send_tristate(RFTransmitter* rf_rmt, uint64_t packed, uint8_t symbol_count, uint8_t proto_idx);
+
+/* Runtime protocol table: the built-in proto[] entries followed by registered ones.
+Entries are never removed, so protocol indices stay valid. Receivers pick up new entries when (re)started */
+const Protocol* rf_protos(void);
+
+uint8_t rf_proto_count(void);
+
+const Protocol* rf_proto_get(uint8_t idx);
+
+// Pulses of every symbol at the protocol's own pulse length, built once at registration
+const RFSymbolTable* rf_proto_symbols(uint8_t idx);
+
+esp_err_t rf_proto_register(const Protocol* protocol, uint8_t* idx);
+
+// Register every protocol of a blob (see rf_proto_parse_blob), all or nothing on malformed input
+esp_err_t rf_proto_load_blob(const uint8_t* blob, size_t len, uint8_t* first_idx);
+
+esp_err_t rf_proto_load_nvs(const char* nvs_namespace, const char* key, uint8_t* first_idx);
+
+// Replay a captured trace (with or without header) through the pulse engine, e.g. to clone a remote
+esp_err_t rf_send_trace(RFTransmitter* rf_rmt, const uint8_t* trace, size_t len);
+
+esp_err_t rf_sched_tx_init(RFTxScheduler* rf_sched);
+
+esp_err_t rf_sched_tx_deinit(RFTxScheduler* rf_sched);
+
+esp_err_t rf_sched_tx_add_pin(RFTxScheduler* rf_sched, gpio_num_t gpio, uint8_t* channel);
+
+/* Send a pulse train repeat times back to back on an idle channel, alongside whatever the other channels
+are sending. The callback runs from the timer ISR with the channel as id once the pin is back low */
+esp_err_t rf_sched_tx_send(RFTxScheduler* rf_sched, uint8_t channel, const RFPulse* pulses, size_t count,
+    uint8_t repeat, RFTxCallback callback, void* arg);
+
+// Same as rf_sched_tx_send for a code of protocol proto_idx
+esp_err_t rf_sched_tx_send_code(RFTxScheduler* rf_sched, uint8_t channel, uint8_t proto_idx, const RFCode* code,
+    uint8_t bit_length, uint8_t repeat, RFTxCallback callback, void* arg);
+
 esp_err_t rf_timer_init(RFTransmitter* rf_rmt);
 
 esp_err_t rf_timer_deinit(gptimer_handle_t timer);
 
 esp_err_t rf_timer_reset(RFTransmitter* rf_rmt);
 
-esp_err_t rf_recv_init(gpio_num_t rx_gpio, RFTransmitter* rf_rmt);
+esp_err_t rf_rmt_tx_init(RFTransmitter* rf_rmt);
+
+esp_err_t rf_rmt_tx_deinit(RFTransmitter* rf_rmt);
+
+esp_err_t rf_rmt_tx_send(RFTransmitter* rf_rmt);
+
+esp_err_t rf_rmt_rx_init(RFReceiver* rf_recv);
+
+esp_err_t rf_rmt_rx_deinit(RFReceiver* rf_recv);
+
+// Decoder task side: replay one captured chunk through the receiver and release its buffer
+void rf_rmt_rx_process(RFReceiver* rf_recv, uint8_t idx);
+
+// Open the echo gate for a transmission expected to last schedule_us, called by rf_send in duplex mode
+void rf_recv_echo_begin(RFReceiver* rf_recv, uint32_t schedule_us);
+
+// Close the echo gate RF_ECHO_GUARD_US from now, called from the transmit completion ISRs
+void rf_recv_echo_end(RFReceiver* rf_recv);
+
+bool rf_recv_post_from_isr(RFReceiver* rf_recv, uint8_t kind, uint8_t idx, BaseType_t* xHigherPriorityTaskWoken);
+
+// Task context counterpart of the edge ISR, for backends that capture whole bursts
+void rf_recv_feed_edge(RFReceiver* rf_recv, uint32_t duration, int64_t time);
+
+/* Keep the receiver armed while sending and drop the edges of our own transmission instead
+of tearing the receiver down, decoding resumes as soon as the last repeat is out */
+esp_err_t rf_set_duplex(RFTransmitter* rf_rmt, bool enable);
+
+esp_err_t rf_set_receiver(RFTransmitter* rf_rmt, RFReceiver* rf_recv);
+
+esp_err_t rf_recv_create(uint8_t id, RFReceiver* rf_recv);
+
+esp_err_t rf_recv_destroy(RFReceiver* rf_recv);
+
+esp_err_t rf_recv_init(gpio_num_t rx_gpio, RFReceiver* rf_recv);
+
+esp_err_t rf_recv_deinit(RFReceiver* rf_recv, bool restore);
+
+esp_err_t rf_recv_set_decoder(UBaseType_t priority, BaseType_t core);
+
+esp_err_t rf_recv_set_mode(RFReceiver* rf_recv, RFDecodeMode mode, uint8_t confirm);
+
+/* min_pulse_us: shorter pulses are glitches, merged back into the pulse they split (0 disables).
+max_edge_rate: edges per second above which the pin is muted for mute_us (0 disables) */
+esp_err_t rf_recv_set_frontend(RFReceiver* rf_recv, uint32_t min_pulse_us, uint32_t max_edge_rate, uint32_t mute_us);
+
+// Select the capture backend, the RMT backend also tightens the timing tolerance to RF_RMT_RX_TOLERANCE
+esp_err_t rf_recv_set_backend(RFReceiver* rf_recv, RFRxBackend backend);
+
+/* Estimate the unit pulse from every pulse of a frame and learn per-remote timing profiles,
+known remotes are then decoded at a narrowed tolerance. Batch mode only, enabling resets the profiles */
+esp_err_t rf_recv_set_calibration(RFReceiver* rf_recv, bool enable);
+
+// Only protocols with their bit set are classified and decoded, fewer protocols mean fewer candidates per frame
+esp_err_t rf_recv_set_protocols(RFReceiver* rf_recv, uint32_t enabled);
+
+/* Route decoded frames through a code registry, which may be shared between receivers.
+Only PRESS, HELD and (unless dropped) UNKNOWN events reach the frame ring, NULL detaches it */
+esp_err_t rf_recv_set_registry(RFReceiver* rf_recv, RFRegistry* registry);
+
+// Registry updates that are safe while receivers are running
+esp_err_t rf_recv_register(RFRegistry* registry, uint8_t proto_idx, const RFCode* code, uint8_t bit_length, uint32_t handle);
+
+esp_err_t rf_recv_unregister(RFRegistry* registry, uint8_t proto_idx, const RFCode* code, uint8_t bit_length);
+
+/* Record every raw edge into buf as trace records (see rf_trace_put), decoding carries on as usual.
+size must be a power of two, a NULL buf stops sniffing */
+esp_err_t rf_recv_set_sniffer(RFReceiver* rf_recv, uint8_t* buf, uint32_t size);
+
+// Drain recorded trace bytes, e.g. to UART or USB. Returns the number of bytes copied
+size_t rf_recv_sniffer_read(RFReceiver* rf_recv, uint8_t* out, size_t max);
+
+/* Drain recorded trace bytes into a flash partition at *offset, which is advanced.
+Writing at offset 0 erases the partition and starts it with the trace header */
+esp_err_t rf_recv_sniffer_to_partition(RFReceiver* rf_recv, const esp_partition_t* partition, size_t* offset);
+
+esp_err_t recv_available(RFReceiver* rf_recv);
+
+void reset_recv(RFReceiver* rf_recv);
+
+esp_err_t rf_recv_wait(RFReceiver* rf_recv, RFRecvFrame* frame, TickType_t timeout);
 
-esp_err_t rf_recv_deinit(RFTransmitter* rf_rmt, bool restore);
+esp_err_t rf_recv_wait_any(RFReceiver* const* receivers, uint8_t count, RFRecvFrame* frame, TickType_t timeout);
 
-esp_err_t recv_available(RFTransmitter* rf_rmt);
+esp_err_t rf_recv_get_stats(RFReceiver* rf_recv, RFRecvStats* stats);
 
-void reset_recv(RFTransmitter* rf_rmt);
+// Reentrant, the result lives entirely in recv_data. ESP_ERR_INVALID_RESPONSE if the code has no tri-state form
+esp_err_t rf_decode_frame(const RFRecvFrame* frame, RFRecvData* recv_data);
 
-void output_recv(RFTransmitter* rf_rmt);
+void output_recv(const RFRecvFrame* frame);
 
 #endif // RF_TEST_H
\ No newline at end of file
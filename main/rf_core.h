@@ -0,0 +1,663 @@
+#ifndef RF_CORE_H
+#define RF_CORE_H
+
+// Hardware-independent types and encoders, usable without ESP-IDF
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Core functions the receive and transmit ISRs call go to IRAM on target, host builds have no such section
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RF_IRAM_ATTR IRAM_ATTR
+#else
+#define RF_IRAM_ATTR
+#endif
+
+#ifndef RF_MAX_CODE_BITS
+#define RF_MAX_CODE_BITS 128
+#endif
+_Static_assert(RF_MAX_CODE_BITS <= 255, "bit lengths are stored in 8 bits");
+#define RF_CODE_WORDS ((RF_MAX_CODE_BITS + 31) / 32)
+#define RF_MAX_SYMBOLS (RF_MAX_CODE_BITS / 2)
+#define RF_MAX_PULSES (RF_MAX_CODE_BITS * 2 + 2)
+#define RF_RECV_RING_SIZE 16
+#define RF_MAX_PROTOCOLS 32
+#define RF_CLASSIFY_TOLERANCE 35
+#define RF_CLASSIFY_PAIRS 3
+#define RF_MAX_CANDIDATES 4
+#define RF_CALIB_PROFILES 32
+#define RF_REGISTRY_SIZE 64
+#define RF_CALIB_PASSES 2
+#define RF_CALIB_MIN_HITS 3
+#define RF_CALIB_MARGIN 5
+// Sync gap, two edges per bit and the closing gap
+#ifndef MAX_EDGES
+#define MAX_EDGES (RF_MAX_CODE_BITS * 2 + 3)
+#endif
+// Shorter frames are taken as noise
+#define RF_MIN_FRAME_EDGES 8
+// Gaps closer than this in length are taken as the same transmission repeated
+#define RF_FRAMER_GAP_MATCH 200
+
+typedef struct {
+    uint8_t high;
+    uint8_t low;
+} RFTicks;
+
+typedef struct {
+    uint16_t pulse_length;
+    RFTicks sync_factor;
+    RFTicks zero;
+    RFTicks one;
+    bool inverted;
+} Protocol;
+
+/* Protocol compiled for the stream decoder: the unit comes from the sync gap with a
+multiply and shift instead of a division, expected durations are the multiples of the unit */
+typedef struct {
+    uint32_t sync_recip;    // 65536 / longest sync half, rounded up
+    RFTicks zero, one;
+    bool inverted;
+} RFProtoTiming;
+
+// Non-zero factors and pulses that fit the pulse format
+bool rf_proto_valid(const Protocol* proto);
+
+void rf_proto_compile(const Protocol* proto, RFProtoTiming* timing);
+
+/* Protocol blob: "RFP", version 1, count, then count records of
+pulse_length (u16 LE), sync high/low, zero high/low, one high/low, flags (bit 0 inverted).
+Returns the number of protocols written to out, 0 if the blob is malformed or any entry invalid */
+#define RF_PROTO_BLOB_VERSION 1
+#define RF_PROTO_BLOB_HEADER 5
+#define RF_PROTO_BLOB_RECORD 9
+uint8_t rf_proto_parse_blob(const uint8_t* blob, size_t len, Protocol* out, uint8_t max);
+
+/* Packed pulse: level in bit 15, duration in timer ticks in bits 14:0.
+This is also the layout of an RMT half symbol, so two consecutive pulses form one RMT symbol word */
+typedef uint16_t RFPulse;
+
+#define RF_PULSE_MAX_TICKS 0x7FFF
+#define RF_PULSE(level, ticks) ((RFPulse)(((level) ? 0x8000 : 0) | ((ticks) & RF_PULSE_MAX_TICKS)))
+#define RF_PULSE_LEVEL(pulse) ((uint8_t)((pulse) >> 15))
+#define RF_PULSE_TICKS(pulse) ((uint32_t)((pulse) & RF_PULSE_MAX_TICKS))
+
+enum {
+    RF_SYMBOL_ZERO,
+    RF_SYMBOL_ONE,
+    RF_SYMBOL_FLOAT,
+    RF_SYMBOL_COUNT,
+};
+
+// Precomputed pulse patterns of a protocol, one 4-pulse group per tri-state symbol
+typedef struct {
+    RFPulse symbol[RF_SYMBOL_COUNT][4];
+    RFPulse sync[2];
+} RFSymbolTable;
+
+// Code of up to RF_MAX_CODE_BITS bits, words[0] holds the least significant 32 bits
+typedef struct {
+    uint32_t words[RF_CODE_WORDS];
+} RFCode;
+
+/* Received bits arrive most significant first, they are collected a word at a time
+so that appending a bit never shifts the whole code */
+typedef struct {
+    uint32_t words[RF_CODE_WORDS];
+    uint32_t cur;
+    uint8_t bits;
+} RFBitAccum;
+
+static inline void rf_accum_reset(RFBitAccum* acc) {
+    acc->cur = 0;
+    acc->bits = 0;
+}
+
+static inline void rf_accum_push(RFBitAccum* acc, uint32_t bit) {
+    acc->cur = (acc->cur << 1) | bit;
+    if ((++acc->bits & 31) == 0) {
+        acc->words[(acc->bits >> 5) - 1] = acc->cur;
+        acc->cur = 0;
+    }
+}
+
+// Right-align the collected bits into a code
+void rf_accum_finish(const RFBitAccum* acc, RFCode* code);
+
+static inline bool rf_code_bit(const RFCode* code, uint8_t bit) {
+    return (code->words[bit >> 5] >> (bit & 31)) & 1;
+}
+
+static inline bool rf_code_equal(const RFCode* a, const RFCode* b) {
+    for (uint8_t i = 0; i < RF_CODE_WORDS; i++)
+        if (a->words[i] != b->words[i]) return false;
+    return true;
+}
+
+static inline uint64_t rf_code_u64(const RFCode* code) {
+    return RF_CODE_WORDS > 1 ? ((uint64_t)code->words[1] << 32) | code->words[0] : code->words[0];
+}
+
+void rf_code_from_u64(RFCode* code, uint64_t value);
+
+// Text forms of a code, filled in place so decoding needs no heap and no shared buffer
+typedef struct {
+    RFCode code;
+    uint8_t bit_length;
+    char binary[RF_MAX_CODE_BITS + 1];
+    char tri_state[RF_MAX_SYMBOLS + 1];  // Empty when a bit pair is not a tri-state symbol
+} RFRecvData;
+
+/* Fill the binary and tri-state strings of the low bit_length bits of a code.
+Returns false if the code has no tri-state form */
+bool rf_decode_code(const RFCode* code, uint8_t bit_length, RFRecvData* data);
+
+// Returns false if a pulse of the protocol does not fit in RF_PULSE_MAX_TICKS
+bool rf_symbol_table_build(const Protocol* proto, RFSymbolTable* table);
+
+/* Encode a tri-state string ('0', '1', 'F') followed by the sync pair into pulses.
+Returns the number of pulses written, or 0 on invalid data or if max_pulses is too small */
+size_t rf_encode_tristate(const RFSymbolTable* table, const char* data, RFPulse* pulses, size_t max_pulses);
+
+// Encode the low bit_length bits of a code, most significant first, followed by the sync pair. In IRAM for the timer ISR
+size_t rf_encode_code(const RFSymbolTable* table, const RFCode* code, uint8_t bit_length, RFPulse* pulses, size_t max_pulses);
+
+/* Encode symbol_count tri-state symbols packed 2 bits each, first symbol in the highest pair:
+00 = '0', 11 = '1', 01 = 'F'. Returns 0 on the invalid pair 10 or if max_pulses is too small */
+size_t rf_encode_tristate_packed(const RFSymbolTable* table, uint64_t packed, uint8_t symbol_count,
+    RFPulse* pulses, size_t max_pulses);
+
+/* A transmission as one pulse train sent repeat times back to back, the final repeat optionally ending
+with a different sync pair. Every edge has a fixed offset from the start, so repeats need no restart */
+typedef struct {
+    uint32_t offset[RF_MAX_PULSES + 1];     // Start of each pulse within a repeat, offset[count] = one repeat
+    uint32_t final_offset[3];               // Last two pulses and the end of the final repeat
+    RFPulse final_sync[2];
+    uint16_t count;
+    uint8_t repeat;
+    bool final;
+} RFTxSchedule;
+
+// final_sync is NULL or the pair replacing the last two pulses in the final repeat. In IRAM, the timer ISR loads every queued item
+bool rf_tx_schedule_build(RFTxSchedule* schedule, const RFPulse* pulses, size_t count, uint8_t repeat,
+    const RFPulse* final_sync);
+
+static inline bool RF_IRAM_ATTR rf_tx_schedule_in_final(const RFTxSchedule* schedule, uint8_t rep, uint16_t i) {
+    return schedule->final && rep == schedule->repeat - 1 && i + 2 >= schedule->count;
+}
+
+// Ticks from the start of the transmission to pulse i of repeat rep, i == count is the end of that repeat
+static inline uint64_t RF_IRAM_ATTR rf_tx_schedule_offset(const RFTxSchedule* schedule, uint8_t rep, uint16_t i) {
+    const uint64_t base = (uint64_t)rep * schedule->offset[schedule->count];
+    if (rf_tx_schedule_in_final(schedule, rep, i)) return base + schedule->final_offset[i + 2 - schedule->count];
+    return base + schedule->offset[i];
+}
+
+static inline RFPulse RF_IRAM_ATTR rf_tx_schedule_pulse(const RFTxSchedule* schedule, const RFPulse* pulses, uint8_t rep, uint16_t i) {
+    return rf_tx_schedule_in_final(schedule, rep, i) ? schedule->final_sync[i + 2 - schedule->count] : pulses[i];
+}
+
+static inline uint64_t RF_IRAM_ATTR rf_tx_schedule_length(const RFTxSchedule* schedule) {
+    return rf_tx_schedule_offset(schedule, schedule->repeat - 1, schedule->count);
+}
+
+typedef enum {
+    RF_RECV_EVENT_FRAME,    // Plain decoded frame, no registry attached
+    RF_RECV_EVENT_PRESS,    // First frame of a registered code
+    RF_RECV_EVENT_HELD,     // Same code still repeating after the held time
+    RF_RECV_EVENT_UNKNOWN,  // First frame of a code that is not registered
+} RFRecvEvent;
+
+typedef struct {
+    RFCode code;
+    uint32_t delay;
+    int64_t timestamp;
+    uint32_t handle;     // Registry handle of the code, PRESS and HELD events only
+    uint8_t bit_length;
+    uint8_t proto;
+    uint8_t quality;     // 100 = every pulse exactly on its expected duration
+    uint8_t candidates;  // protocols that matched the frame signature, >1 means ambiguous
+    uint8_t rx_id;
+    uint8_t event;       // RFRecvEvent
+} RFRecvFrame;
+
+/* Lock-free single-producer/single-consumer ring of received frames.
+head is only written by the producer, tail only by the consumer, RF_RECV_RING_SIZE must be a power of two */
+typedef struct {
+    RFRecvFrame frames[RF_RECV_RING_SIZE];
+    uint32_t head, tail;
+    uint32_t overflows;
+} RFRecvRing;
+
+static inline void rf_ring_reset(RFRecvRing* ring) {
+    __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, 0, __ATOMIC_RELAXED);
+    ring->overflows = 0;
+}
+
+static inline uint32_t rf_ring_count(const RFRecvRing* ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// Producer side, drops the frame and counts an overflow when the ring is full
+static inline bool rf_ring_push(RFRecvRing* ring, const RFRecvFrame* frame) {
+    const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= RF_RECV_RING_SIZE) {
+        __atomic_store_n(&ring->overflows, ring->overflows + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    ring->frames[head & (RF_RECV_RING_SIZE - 1)] = *frame;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side, oldest frame without removing it
+static inline const RFRecvFrame* rf_ring_peek(const RFRecvRing* ring) {
+    const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) return NULL;
+    return &ring->frames[tail & (RF_RECV_RING_SIZE - 1)];
+}
+
+// Consumer side
+static inline bool rf_ring_pop(RFRecvRing* ring, RFRecvFrame* frame) {
+    const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) return false;
+    *frame = ring->frames[tail & (RF_RECV_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side, discards every pending frame
+static inline void rf_ring_flush(RFRecvRing* ring) {
+    __atomic_store_n(&ring->tail, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+// Q8 fixed-point duration ratio
+#define RF_RATIO(num, den) ((den) ? ((uint32_t)(num) << 8) / (den) : UINT32_MAX)
+
+typedef struct {
+    uint32_t ratio;
+    uint8_t proto;
+} RFRatioEntry;
+
+/* Protocol signatures sorted by sync ratio (long / short half of the sync), split by
+where the short half sits: last timing of the frame for normal protocols, second timing for inverted ones */
+typedef struct {
+    uint8_t normal_count, inverted_count;
+    RFRatioEntry normal[RF_MAX_PROTOCOLS];
+    RFRatioEntry inverted[RF_MAX_PROTOCOLS];
+    uint32_t zero_ratio[RF_MAX_PROTOCOLS], one_ratio[RF_MAX_PROTOCOLS];
+} RFProtoIndex;
+
+typedef struct {
+    uint8_t proto;
+    uint8_t score;  // Mean signature deviation in percent, lower is better
+} RFCandidate;
+
+void rf_proto_index_build(RFProtoIndex* index, const Protocol* protos, uint8_t proto_count);
+
+// Only the protocols with their bit set in enabled become classification candidates
+void rf_proto_index_build_mask(RFProtoIndex* index, const Protocol* protos, uint8_t proto_count, uint32_t enabled);
+
+/* Look up the protocols whose sync ratio and first data pairs fit the timing frame.
+Candidates are written best first, returns how many were found (at most max_candidates) */
+uint8_t rf_classify(const RFProtoIndex* index, const uint32_t* timings, uint32_t edge_count,
+    RFCandidate* candidates, uint8_t max_candidates);
+
+/* Decode one timing frame (sync gap first) with a given protocol and unit pulse length.
+Sets code, delay, bit_length and quality, the caller fills in the frame origin.
+If max_dev is set it receives the largest pulse deviation in percent of the unit */
+bool rf_decode_timings_unit(const Protocol* proto, const uint32_t* timings, uint32_t edge_count,
+    uint32_t delay, uint8_t tolerance, RFRecvFrame* frame, uint32_t* max_dev);
+
+// Same, with the unit taken from the sync gap
+bool rf_decode_timings(const Protocol* proto, const uint32_t* timings, uint32_t edge_count,
+    uint8_t tolerance, RFRecvFrame* frame);
+
+/* Classify a timing frame and decode it with the best fitting candidate that decodes cleanly.
+Returns false if no candidate protocol decodes it. If rejected is set, it receives a bit per
+candidate protocol that fit the signature but failed to decode */
+bool rf_decode_batch(const RFProtoIndex* index, const Protocol* protos, const uint32_t* timings,
+    uint32_t edge_count, uint8_t tolerance, RFRecvFrame* frame, uint32_t* rejected);
+
+// Unit pulse length estimated from every pulse of the frame rather than the sync gap alone
+uint32_t rf_estimate_unit(const Protocol* proto, const uint32_t* timings, uint32_t edge_count);
+
+// Timing learned for one remote, i.e. one (protocol, code) pair
+typedef struct {
+    RFCode code;
+    uint32_t unit;
+    uint32_t max_dev;    // Averaged largest pulse deviation, percent of the unit
+    uint32_t last_use;
+    uint16_t hits;
+    uint8_t proto, bit_length;
+    uint8_t tolerance;   // Narrowed tolerance once the profile has RF_CALIB_MIN_HITS frames
+} RFTimingProfile;
+
+typedef struct {
+    RFTimingProfile profiles[RF_CALIB_PROFILES];
+    uint32_t clock;
+    uint8_t count;
+    uint8_t min_tolerance;
+} RFCalibration;
+
+void rf_calib_reset(RFCalibration* calib, uint8_t min_tolerance);
+
+const RFTimingProfile* rf_calib_lookup(const RFCalibration* calib, uint8_t proto, const RFCode* code, uint8_t bit_length);
+
+/* rf_decode_batch with the unit estimated from all pulses and per-remote profiles. A known remote
+outside its narrowed tolerance only decodes when no other candidate does, and widens its profile.
+The learned unit of a known remote is tried when the estimate fails */
+bool rf_decode_calibrated(RFCalibration* calib, const RFProtoIndex* index, const Protocol* protos,
+    const uint32_t* timings, uint32_t edge_count, uint8_t tolerance, RFRecvFrame* frame, uint32_t* rejected);
+
+/* Known codes mapped to user handles, open addressing with linear probing.
+Frames of one code closer together than holdoff are one press, RF_REGISTRY_SIZE must be a power of two */
+enum {
+    RF_REGISTRY_EMPTY,
+    RF_REGISTRY_USED,
+    RF_REGISTRY_DELETED,
+};
+
+typedef struct {
+    RFCode code;
+    int64_t first_seen, last_seen;
+    uint32_t handle;
+    uint8_t proto, bit_length;
+    uint8_t state;
+    bool held;
+} RFRegistryEntry;
+
+typedef struct {
+    RFRegistryEntry entries[RF_REGISTRY_SIZE];
+    RFRegistryEntry unknown;    // Last unregistered code, so its repeats collapse too
+    uint32_t holdoff;           // Longest gap between frames of one press
+    uint32_t held_after;        // Press length that raises the held event, 0 disables it
+    uint16_t count;
+    bool drop_unknown;
+} RFRegistry;
+
+void rf_registry_init(RFRegistry* reg, uint32_t holdoff, uint32_t held_after, bool drop_unknown);
+
+// False when the table is full, an existing entry gets the new handle
+bool rf_registry_add(RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length, uint32_t handle);
+
+bool rf_registry_remove(RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length);
+
+const RFRegistryEntry* rf_registry_find(const RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length);
+
+// Sets the frame event and handle, false when the frame is a repeat or a dropped unknown code. In IRAM, stream mode feeds it from the ISR
+bool rf_registry_feed(RFRegistry* reg, RFRecvFrame* frame);
+
+/* Splits the edge stream into timing frames. A frame is the run of edges after a gap,
+it is complete when the next gap has about the same length, i.e. the transmission repeats */
+typedef struct {
+    uint32_t separation_limit;
+    uint32_t edge_count, repeat_count;
+} RFFramer;
+
+static inline void rf_framer_reset(RFFramer* framer, uint32_t separation_limit) {
+    framer->separation_limit = separation_limit;
+    framer->edge_count = 0;
+    framer->repeat_count = 0;
+}
+
+/* Returns true when duration closes the frame held in timings[0, edge_count).
+The caller takes the frame and may switch buffers before rf_framer_push stores duration */
+static inline bool rf_framer_closes(RFFramer* framer, const uint32_t* timings, uint32_t duration) {
+    if (duration <= framer->separation_limit) return false;
+
+    // Long stretch without signal level change -> presumably the gap between two transmissions
+    const uint32_t d = duration > timings[0] ? duration - timings[0] : timings[0] - duration;
+    if (framer->repeat_count == 0 || d < RF_FRAMER_GAP_MATCH) {
+        /* Assuming the sender sending the signal multiple times with roughly the same gap period,
+        this long signal is close in length to the signal which start the previous records
+        -> potentially confirming it being a gap between two transmissions */
+        if (++framer->repeat_count == 2) {
+            framer->repeat_count = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Store duration, a gap starts a new frame in timings. Returns false if the frame overran MAX_EDGES and was discarded
+static inline bool rf_framer_push(RFFramer* framer, uint32_t* timings, uint32_t duration) {
+    bool fits = true;
+    if (duration > framer->separation_limit) framer->edge_count = 0;
+    if (framer->edge_count >= MAX_EDGES) {
+        framer->edge_count = 0;
+        framer->repeat_count = 0;
+        fits = false;
+    }
+    timings[framer->edge_count++] = duration;
+    return fits;
+}
+
+/* Removes pulses shorter than min_pulse. A spike splits a pulse into three edges, they are merged
+back into one, so every duration is released one edge late */
+typedef struct {
+    uint32_t min_pulse;
+    uint32_t held;
+    bool merge_next;
+} RFGlitchFilter;
+
+static inline void rf_glitch_reset(RFGlitchFilter* filter, uint32_t min_pulse) {
+    filter->min_pulse = min_pulse;
+    filter->held = 0;
+    filter->merge_next = false;
+}
+
+// Returns true with the released duration in out, false while a duration is held or merged
+static inline bool rf_glitch_feed(RFGlitchFilter* filter, uint32_t duration, uint32_t* out) {
+    if (filter->merge_next || duration < filter->min_pulse) {
+        filter->held += duration;
+        filter->merge_next = !filter->merge_next;
+        return false;
+    }
+    *out = filter->held;
+    filter->held = duration;
+    return *out != 0;
+}
+
+/* Edge rate limiter: more than max_edges edges within window ticks asks the caller to stop
+listening for a while, which bounds the reception cost whatever the noise floor */
+typedef struct {
+    uint32_t window, max_edges;
+    uint32_t edges;
+    int64_t window_start;
+} RFRateLimit;
+
+static inline void rf_rate_limit_reset(RFRateLimit* limit, uint32_t window, uint32_t max_edges) {
+    limit->window = window;
+    limit->max_edges = max_edges;
+    limit->edges = 0;
+    limit->window_start = 0;
+}
+
+// Returns true when the edge at time exceeds the rate, max_edges 0 never does
+static inline bool rf_rate_limit_feed(RFRateLimit* limit, int64_t time) {
+    if (!limit->max_edges) return false;
+    if (time - limit->window_start >= limit->window) {
+        limit->window_start = time;
+        limit->edges = 0;
+    }
+    return ++limit->edges > limit->max_edges;
+}
+
+typedef enum {
+    RF_STREAM_IDLE,
+    RF_STREAM_SKIP,
+    RF_STREAM_DATA,
+} RFStreamPhase;
+
+// Per-protocol incremental decoding state, expected durations are scaled once per frame from the sync gap
+typedef struct {
+    uint8_t phase;
+    bool has_first;
+    RFBitAccum code;
+    uint32_t first, delay, tolerance, deviation;
+    uint32_t zero_high, zero_low, one_high, one_low;
+} RFStreamState;
+
+typedef struct {
+    const Protocol* protos;
+    uint8_t proto_count, tolerance, confirm, repeats;
+    uint8_t active_count;
+    uint8_t active[RF_MAX_PROTOCOLS];     // Enabled protocols, the only ones run per edge
+    uint32_t tolerance_q16;               // tolerance / 100 in Q16
+    uint32_t separation_limit;
+    RFRecvFrame last;
+    RFProtoTiming timing[RF_MAX_PROTOCOLS];
+    RFStreamState state[RF_MAX_PROTOCOLS];
+} RFStreamDecoder;
+
+/* confirm is the number of identical consecutive frames required before one is reported,
+0 or 1 reports every valid frame */
+void rf_stream_init(RFStreamDecoder* dec, const Protocol* protos, uint8_t proto_count,
+    uint8_t tolerance, uint32_t separation_limit, uint8_t confirm);
+
+void rf_stream_reset(RFStreamDecoder* dec);
+
+// Restrict decoding to the protocols with their bit set, all are enabled after rf_stream_init
+void rf_stream_enable(RFStreamDecoder* dec, uint32_t enabled);
+
+// Advance every protocol state machine by one edge duration, returns true when frame holds a decoded code
+bool rf_stream_feed(RFStreamDecoder* dec, uint32_t duration, int64_t timestamp, RFRecvFrame* frame);
+
+/* Prepared-code cache: encoded pulse trains kept in a caller-provided arena, placed first fit and
+evicted least recently used first unless pinned. A handle carries its entry's generation, so a handle
+to an evicted entry is rejected instead of pointing at someone else's pulses */
+#define RF_CACHE_ENTRIES 64
+
+typedef uint32_t RFCacheHandle;     // 0 = none
+
+typedef struct {
+    RFCode code;
+    uint32_t last_use;
+    uint16_t offset, count;     // Pulses in the arena
+    uint16_t generation;
+    uint8_t proto_idx, bit_length;
+    uint8_t pins;
+    bool used;
+    bool ready;                 // Pulses written, hidden from lookups while reserved
+} RFCacheEntry;
+
+typedef struct {
+    uint32_t entries, arena_used;
+    uint32_t hits, misses, evictions, failures;
+} RFCacheStats;
+
+typedef struct {
+    RFPulse* arena;
+    uint32_t arena_size;
+    RFCacheEntry entries[RF_CACHE_ENTRIES];
+    uint8_t order[RF_CACHE_ENTRIES];    // Live slots by arena offset
+    uint8_t live;
+    uint32_t clock;
+    RFCacheStats stats;
+} RFCodeCache;
+
+void rf_cache_init(RFCodeCache* cache, RFPulse* arena, uint32_t arena_size);
+
+// Handle of an already prepared code, 0 when it is not cached
+RFCacheHandle rf_cache_find(RFCodeCache* cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length);
+
+/* Find the code, or reserve count pulses of the arena for it, evicting unpinned entries as needed.
+A new entry comes back pinned and hidden with *pulses set, the caller fills in what rf_encode_code
+produces, outside its lock, and then commits it. *pulses stays NULL for a code already cached.
+0 when count does not fit the code or everything left in the arena is pinned */
+RFCacheHandle rf_cache_reserve(RFCodeCache* cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+    uint16_t count, RFPulse** pulses);
+
+// Publish a reserved entry once its pulses are written, and drop the reservation pin
+void rf_cache_commit(RFCodeCache* cache, RFCacheHandle handle);
+
+// The entry behind handle, NULL once it was evicted or removed. Counts as a use. In IRAM for the timer ISR
+const RFCacheEntry* rf_cache_get(RFCodeCache* cache, RFCacheHandle handle);
+
+static inline const RFPulse* rf_cache_pulses(const RFCodeCache* cache, const RFCacheEntry* entry) {
+    return cache->arena + entry->offset;
+}
+// Pinned entries are never evicted, pins nest. Unpin is in IRAM, the timer ISR drops the pin of a sent item
+// Pinned entries are never evicted, pins nest
+bool rf_cache_pin(RFCodeCache* cache, RFCacheHandle handle);
+
+bool rf_cache_unpin(RFCodeCache* cache, RFCacheHandle handle);
+
+// Drop an unpinned entry
+bool rf_cache_remove(RFCodeCache* cache, RFCacheHandle handle);
+
+/* Merged edge schedule for several pulse trains sharing one timer. Channels sit in a min-heap
+keyed by the absolute tick of their next edge, every step applies all edges due within merge ticks
+of the earliest one, so each pin's edges land at most merge ticks early */
+#define RF_SCHED_CHANNELS 8
+#define RF_SCHED_MERGE_TICKS 2
+
+typedef struct {
+    const RFPulse* pulses;
+    size_t count, index;    // index of the pulse being output, SIZE_MAX before the first one
+    uint64_t next;          // Tick of the channel's next edge
+    uint8_t repeat, rep;
+    bool active;
+} RFSchedChannel;
+
+typedef struct {
+    RFSchedChannel channels[RF_SCHED_CHANNELS];
+    uint8_t heap[RF_SCHED_CHANNELS];
+    uint8_t heap_count;
+    uint32_t merge;
+} RFSched;
+
+void rf_sched_init(RFSched* sched, uint32_t merge);
+
+// Queue a pulse train on an idle channel, its first pulse starts at tick start. Repeats follow back to back
+bool rf_sched_start(RFSched* sched, uint8_t channel, const RFPulse* pulses, size_t count, uint8_t repeat, uint64_t start);
+
+// Tick of the earliest pending edge, UINT64_MAX when every channel is idle
+static inline uint64_t rf_sched_next(const RFSched* sched) {
+    return sched->heap_count ? sched->channels[sched->heap[0]].next : UINT64_MAX;
+}
+
+/* Apply the edges due at the earliest pending tick (returned). Channel bits are set in high or low
+for the level they change to, and in done for channels that finished and were driven low. In IRAM for the timer ISR */
+uint64_t rf_sched_step(RFSched* sched, uint32_t* high, uint32_t* low, uint32_t* done);
+
+/* Raw edge trace: one LEB128 varint per pulse, (duration << 1) | level, level being the line level
+during the pulse. Stored traces start with the RF_TRACE_MAGIC header, rings carry bare records */
+#define RF_TRACE_MAGIC "RFT1"
+#define RF_TRACE_HEADER 4
+#define RF_TRACE_MAX_RECORD 5
+
+// Returns the record length, out needs RF_TRACE_MAX_RECORD bytes
+size_t rf_trace_put(uint8_t* out, uint8_t level, uint32_t duration);
+
+// Returns the bytes consumed, 0 if the record is truncated or malformed
+size_t rf_trace_get(const uint8_t* in, size_t len, uint8_t* level, uint32_t* duration);
+
+// Length of the header at the start of trace, 0 for a bare record stream
+size_t rf_trace_skip_header(const uint8_t* trace, size_t len);
+
+/* Convert a trace (with or without header) to a pulse train. Pulses longer than the pulse format
+are clamped, returns the number of pulses or 0 if the trace does not fit or is malformed */
+size_t rf_trace_to_pulses(const uint8_t* trace, size_t len, RFPulse* pulses, size_t max_pulses);
+
+/* Single-producer/single-consumer byte ring of trace records. size must be a power of two,
+a record that does not fit whole is dropped and counted */
+typedef struct {
+    uint8_t* buf;
+    uint32_t size;
+    uint32_t head, tail;
+    uint32_t dropped;
+} RFTraceRing;
+
+void rf_trace_ring_init(RFTraceRing* ring, uint8_t* buf, uint32_t size);
+
+bool rf_trace_ring_push(RFTraceRing* ring, uint8_t level, uint32_t duration);
+
+// Consumer side, copies out up to max bytes. Records may be split between reads
+size_t rf_trace_ring_read(RFTraceRing* ring, uint8_t* out, size_t max);
+
+#endif // RF_CORE_H
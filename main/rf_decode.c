@@ -0,0 +1,78 @@
+#include "rf_core.h"
+
+static inline uint32_t diff(uint32_t a, uint32_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+static inline uint32_t sync_len_in_pulses(const Protocol* proto) {
+    return proto->sync_factor.low > proto->sync_factor.high ? proto->sync_factor.low : proto->sync_factor.high;
+}
+
+static inline uint32_t max_pair_dev(uint32_t a, uint32_t b) {
+    return a > b ? a : b;
+}
+
+bool rf_decode_timings_unit(const Protocol* proto, const uint32_t* timings, uint32_t edge_count,
+        uint32_t delay, uint8_t tolerance, RFRecvFrame* frame, uint32_t* max_dev) {
+    // Ignore very short transmissions (Presumably noise)
+    if (edge_count < RF_MIN_FRAME_EDGES || delay == 0) return false;
+
+    RFBitAccum code;
+    uint32_t dev_sum = 0, dev_max = 0, pulses = 0;
+    rf_accum_reset(&code);
+    const uint32_t delay_tolerance = delay * tolerance / 100;
+    const uint32_t zero_high = delay * proto->zero.high, zero_low = delay * proto->zero.low;
+    const uint32_t one_high = delay * proto->one.high, one_low = delay * proto->one.low;
+
+    const uint32_t first_data_timing = proto->inverted ? 2 : 1;
+    for (uint32_t i = first_data_timing; i < edge_count - 1; i += 2) {
+        uint32_t dev_high, dev_low;
+        if (code.bits >= RF_MAX_CODE_BITS) return false;
+        if (diff(timings[i], zero_high) < delay_tolerance && diff(timings[i + 1], zero_low) < delay_tolerance) {
+            rf_accum_push(&code, 0);
+            dev_high = diff(timings[i], zero_high);
+            dev_low = diff(timings[i + 1], zero_low);
+        } else if (diff(timings[i], one_high) < delay_tolerance && diff(timings[i + 1], one_low) < delay_tolerance) {
+            rf_accum_push(&code, 1);
+            dev_high = diff(timings[i], one_high);
+            dev_low = diff(timings[i + 1], one_low);
+        } else {
+            return false;
+        }
+        dev_sum += dev_high + dev_low;
+        dev_max = max_pair_dev(dev_max, max_pair_dev(dev_high, dev_low));
+        pulses += 2;
+    }
+
+    const uint32_t mean_dev = pulses ? dev_sum * 100 / (pulses * delay) : 100;
+    rf_accum_finish(&code, &frame->code);
+    frame->delay = delay;
+    frame->bit_length = code.bits;
+    frame->quality = mean_dev >= 100 ? 0 : 100 - mean_dev;
+    if (max_dev) *max_dev = dev_max * 100 / delay;
+    return true;
+}
+
+bool rf_decode_timings(const Protocol* proto, const uint32_t* timings, uint32_t edge_count,
+        uint8_t tolerance, RFRecvFrame* frame) {
+    return rf_decode_timings_unit(proto, timings, edge_count, timings[0] / sync_len_in_pulses(proto),
+        tolerance, frame, NULL);
+}
+
+bool rf_decode_batch(const RFProtoIndex* index, const Protocol* protos, const uint32_t* timings,
+        uint32_t edge_count, uint8_t tolerance, RFRecvFrame* frame, uint32_t* rejected) {
+    RFCandidate candidates[RF_MAX_CANDIDATES];
+    if (rejected) *rejected = 0;
+
+    // Only the protocols whose signature fits the frame are decoded, best match first
+    const uint8_t count = rf_classify(index, timings, edge_count, candidates, RF_MAX_CANDIDATES);
+    for (uint8_t i = 0; i < count; i++) {
+        if (rf_decode_timings(&protos[candidates[i].proto], timings, edge_count, tolerance, frame)) {
+            frame->proto = candidates[i].proto;
+            frame->candidates = count;
+            return true;
+        }
+        if (rejected) *rejected |= 1UL << candidates[i].proto;
+    }
+    return false;
+}
@@ -0,0 +1,105 @@
+#include <string.h>
+#include "rf_core.h"
+
+static bool make_pair(const Protocol* proto, RFTicks ticks, RFPulse* out) {
+    const uint8_t first_logic = proto->inverted ? 0 : 1;
+    const uint32_t high = (uint32_t)ticks.high * proto->pulse_length;
+    const uint32_t low = (uint32_t)ticks.low * proto->pulse_length;
+    if (high > RF_PULSE_MAX_TICKS || low > RF_PULSE_MAX_TICKS) return false;
+
+    out[0] = RF_PULSE(first_logic, high);
+    out[1] = RF_PULSE(!first_logic, low);
+    return true;
+}
+
+bool rf_symbol_table_build(const Protocol* proto, RFSymbolTable* table) {
+    if (!proto || !table) return false;
+
+    // '0' = zero zero, '1' = one one, 'F' = zero one
+    return make_pair(proto, proto->zero, &table->symbol[RF_SYMBOL_ZERO][0]) &&
+        make_pair(proto, proto->zero, &table->symbol[RF_SYMBOL_ZERO][2]) &&
+        make_pair(proto, proto->one, &table->symbol[RF_SYMBOL_ONE][0]) &&
+        make_pair(proto, proto->one, &table->symbol[RF_SYMBOL_ONE][2]) &&
+        make_pair(proto, proto->zero, &table->symbol[RF_SYMBOL_FLOAT][0]) &&
+        make_pair(proto, proto->one, &table->symbol[RF_SYMBOL_FLOAT][2]) &&
+        make_pair(proto, proto->sync_factor, table->sync);
+}
+
+size_t rf_encode_tristate(const RFSymbolTable* table, const char* data, RFPulse* pulses, size_t max_pulses) {
+    if (!table || !data || !pulses) return 0;
+
+    size_t idx = 0;
+    for (; *data; data++) {
+        uint8_t symbol;
+        switch (*data) {
+            case '0': symbol = RF_SYMBOL_ZERO; break;
+            case '1': symbol = RF_SYMBOL_ONE; break;
+            case 'F': symbol = RF_SYMBOL_FLOAT; break;
+            default: return 0;
+        }
+        if (idx + 4 + 2 > max_pulses) return 0;
+        memcpy(&pulses[idx], table->symbol[symbol], sizeof(table->symbol[symbol]));
+        idx += 4;
+    }
+
+    if (idx + 2 > max_pulses) return 0;
+    pulses[idx++] = table->sync[0];
+    pulses[idx++] = table->sync[1];
+    return idx;
+}
+
+size_t RF_IRAM_ATTR rf_encode_code(const RFSymbolTable* table, const RFCode* code, uint8_t bit_length, RFPulse* pulses, size_t max_pulses) {
+    if (!table || !code || !pulses || bit_length > RF_MAX_CODE_BITS) return 0;
+    if ((size_t)bit_length * 2 + 2 > max_pulses) return 0;
+
+    // A binary bit is one half of a tri-state symbol: '0' and '1' are both halves of their own symbol
+    size_t idx = 0;
+    for (uint8_t i = bit_length; i > 0; i--) {
+        const RFPulse* pair = table->symbol[rf_code_bit(code, i - 1) ? RF_SYMBOL_ONE : RF_SYMBOL_ZERO];
+        pulses[idx++] = pair[0];
+        pulses[idx++] = pair[1];
+    }
+
+    pulses[idx++] = table->sync[0];
+    pulses[idx++] = table->sync[1];
+    return idx;
+}
+
+size_t rf_encode_tristate_packed(const RFSymbolTable* table, uint64_t packed, uint8_t symbol_count,
+        RFPulse* pulses, size_t max_pulses) {
+    if (!table || !pulses || symbol_count > 32) return 0;
+    if ((size_t)symbol_count * 4 + 2 > max_pulses) return 0;
+
+    static const int8_t pair_symbol[4] = { RF_SYMBOL_ZERO, RF_SYMBOL_FLOAT, -1, RF_SYMBOL_ONE };
+    size_t idx = 0;
+    for (uint8_t i = symbol_count; i > 0; i--) {
+        const int8_t symbol = pair_symbol[(packed >> ((i - 1) * 2)) & 3];
+        if (symbol < 0) return 0;
+        memcpy(&pulses[idx], table->symbol[symbol], sizeof(table->symbol[symbol]));
+        idx += 4;
+    }
+
+    pulses[idx++] = table->sync[0];
+    pulses[idx++] = table->sync[1];
+    return idx;
+}
+
+bool RF_IRAM_ATTR rf_tx_schedule_build(RFTxSchedule* schedule, const RFPulse* pulses, size_t count, uint8_t repeat,
+        const RFPulse* final_sync) {
+    if (!pulses || !count || count > RF_MAX_PULSES || !repeat || (final_sync && count < 2)) return false;
+
+    schedule->offset[0] = 0;
+    for (size_t i = 0; i < count; i++)
+        schedule->offset[i + 1] = schedule->offset[i] + RF_PULSE_TICKS(pulses[i]);
+    schedule->count = count;
+    schedule->repeat = repeat;
+    schedule->final = final_sync != NULL;
+    if (schedule->final) {
+        schedule->final_sync[0] = final_sync[0];
+        schedule->final_sync[1] = final_sync[1];
+        schedule->final_offset[0] = schedule->offset[count - 2];
+        schedule->final_offset[1] = schedule->final_offset[0] + RF_PULSE_TICKS(final_sync[0]);
+        schedule->final_offset[2] = schedule->final_offset[1] + RF_PULSE_TICKS(final_sync[1]);
+    }
+    return true;
+}
@@ -0,0 +1,204 @@
+#include <string.h>
+#include "rf_loopback.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "esp_rom_sys.h"
+
+// With partial receive the capture may outgrow the buffer, it is then handed over piece by piece
+#if SOC_RMT_SUPPORT_RX_PINGPONG && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#define RF_LOOPBACK_PARTIAL 1
+#else
+#define RF_LOOPBACK_PARTIAL 0
+#endif
+
+typedef struct {
+    RFTransmitter* tx;
+    TaskHandle_t task;
+    rmt_channel_handle_t rx_chan;
+    rmt_receive_config_t rx_config;
+    rmt_symbol_word_t* symbols;
+    uint32_t* edges;
+    size_t max_edges;
+    uint32_t time;
+    uint8_t level;
+    volatile size_t count;
+    volatile bool overflow, done;
+} RFLoopback;
+
+typedef struct {
+    portMUX_TYPE lock;
+    uint16_t critical_us;
+    volatile bool stop;
+    volatile uint8_t running;
+} RFLoopbackLoad;
+
+/* The channel measures every level in hardware at DEFAULT_RESOLUTION, the same unit as the transmit
+timer's ticks. Edges are the running sum of the levels from the first one, which the capture starts on */
+static bool IRAM_ATTR loopback_rx_done(rmt_channel_handle_t chan, const rmt_rx_done_event_data_t *edata, void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    RFLoopback* loopback = (RFLoopback*)arg;
+    for (size_t i = 0; i < edata->num_symbols; i++) {
+        const rmt_symbol_word_t symbol = edata->received_symbols[i];
+        const uint8_t levels[2] = { symbol.level0, symbol.level1 };
+        const uint16_t durations[2] = { symbol.duration0, symbol.duration1 };
+        for (uint8_t h = 0; h < 2 && durations[h]; h++) {
+            if (levels[h] != loopback->level) {
+                if (loopback->count < loopback->max_edges) loopback->edges[loopback->count++] = loopback->time;
+                else loopback->overflow = true;
+                loopback->level = levels[h];
+            }
+            loopback->time += durations[h];
+        }
+    }
+#if RF_LOOPBACK_PARTIAL
+    if (!edata->flags.is_last) return false;
+#endif
+    // The line sat idle past the range, so it went back low after the last level
+    if (loopback->level) {
+        if (loopback->count < loopback->max_edges) loopback->edges[loopback->count++] = loopback->time;
+        else loopback->overflow = true;
+    }
+    loopback->done = true;
+    vTaskNotifyGiveFromISR(loopback->task, &xHigherPriorityTaskWoken);
+    return (xHigherPriorityTaskWoken == pdTRUE);
+}
+
+static bool loopback_send(void* ctx, const RFPulse* pulses, size_t count, uint8_t repeat,
+        uint32_t* edges, size_t max_edges, size_t* edge_count) {
+    RFLoopback* loopback = (RFLoopback*)ctx;
+    RFTransmitter* rf_rmt = loopback->tx;
+    if (count > RF_MAX_PULSES || rf_rmt->tx_active) return false;
+
+    loopback->edges = edges;
+    loopback->max_edges = max_edges;
+    loopback->count = 0;
+    loopback->time = 0;
+    loopback->level = 0;
+    loopback->overflow = false;
+    loopback->done = false;
+    memcpy(rf_rmt->pulses, pulses, count * sizeof(RFPulse));
+    rf_rmt->pulse_count = count;
+    rf_rmt->tx_repeats = repeat;
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    if (rmt_receive(loopback->rx_chan, loopback->symbols, RF_LOOPBACK_BUFFER_SYMBOLS * sizeof(rmt_symbol_word_t),
+            &loopback->rx_config) != ESP_OK)
+        return false;
+    if (rf_send_start(rf_rmt) != ESP_OK) {
+        rmt_disable(loopback->rx_chan);
+        rmt_enable(loopback->rx_chan);
+        return false;
+    }
+    // The timer ISR notifies once the final repeat is out, the channel once the line has gone idle
+    while (rf_rmt->tx_active || !loopback->done) {
+        if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RF_LOOPBACK_TIMEOUT_MS))) {
+            if (rf_rmt->tx_active) rf_timer_reset(rf_rmt);
+            // Disabling the channel drops the capture still pending
+            rmt_disable(loopback->rx_chan);
+            rmt_enable(loopback->rx_chan);
+            return false;
+        }
+    }
+    *edge_count = loopback->count;
+    return !loopback->overflow;
+}
+
+static void loopback_load_task(void* arg) {
+    RFLoopbackLoad* load = (RFLoopbackLoad*)arg;
+    uint32_t iterations = 0;
+    while (!load->stop) {
+        portENTER_CRITICAL(&load->lock);
+        esp_rom_delay_us(load->critical_us);
+        portEXIT_CRITICAL(&load->lock);
+        esp_rom_delay_us(RF_LOOPBACK_LOAD_BUSY_US);
+        // Let the idle task run now and then, the task watchdog watches it
+        if (++iterations % 16 == 0) vTaskDelay(1);
+    }
+    __atomic_fetch_sub(&load->running, 1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+esp_err_t rf_loopback_run(RFTransmitter* rf_rmt, const RFLoopbackConfig* loopback, const RFSelftestConfig* config,
+        RFSelftestResult* result) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && loopback && config && result, ESP_ERR_INVALID_ARG, TAG, "Invalid RF loopback");
+    ESP_RETURN_ON_FALSE(rf_rmt->tx_backend == RF_TX_BACKEND_GPTIMER, ESP_ERR_NOT_SUPPORTED, TAG, "Loopback tests the GPTimer backend");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+    esp_err_t ret = ESP_OK;
+
+    static RFLoopback state;
+    memset(&state, 0, sizeof(state));
+    state.tx = rf_rmt;
+    state.task = xTaskGetCurrentTaskHandle();
+    state.symbols = heap_caps_calloc(RF_LOOPBACK_BUFFER_SYMBOLS, sizeof(rmt_symbol_word_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    ESP_RETURN_ON_FALSE(state.symbols, ESP_ERR_NO_MEM, TAG, "Failed to allocate loopback capture buffer");
+
+    const gpio_num_t capture_gpio = loopback->capture_gpio == GPIO_NUM_NC ? rf_rmt->tx_gpio : loopback->capture_gpio;
+    rmt_rx_channel_config_t rx_chan_config = {
+        .gpio_num = capture_gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DEFAULT_RESOLUTION,
+        .mem_block_symbols = RF_RMT_RX_MEM_SYMBOLS,
+#if SOC_RMT_SUPPORT_DMA
+        .flags.with_dma = true,
+#endif
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_rx_channel(&rx_chan_config, &state.rx_chan), err, TAG, "Failed to create loopback RMT RX channel");
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = loopback_rx_done,
+    };
+    ESP_GOTO_ON_ERROR(rmt_rx_register_event_callbacks(state.rx_chan, &cbs, &state), err, TAG, "Failed to register loopback RMT RX callbacks");
+    ESP_GOTO_ON_ERROR(rmt_enable(state.rx_chan), err, TAG, "Failed to enable loopback RMT RX channel");
+    // The channel took the pin as an input, the transmitter still drives it
+    if (capture_gpio == rf_rmt->tx_gpio)
+        ESP_GOTO_ON_ERROR(gpio_set_direction(capture_gpio, GPIO_MODE_INPUT_OUTPUT), err_enabled, TAG, "Failed to loop the TX pin back");
+    // Idle past the longest level of any protocol ends the capture
+    state.rx_config = (rmt_receive_config_t) {
+        .signal_range_min_ns = RF_RMT_RX_MIN_NS,
+        .signal_range_max_ns = RF_RMT_RX_IDLE_US * 1000,
+#if RF_LOOPBACK_PARTIAL
+        .flags.en_partial_rx = true,
+#endif
+    };
+
+    RFReceiver* rx = rf_rmt->rx;
+    TaskHandle_t notify = rf_rmt->rf_trans_handle;
+    const bool final = rf_rmt->tx_final;
+    rf_rmt->rx = NULL;
+    rf_rmt->rf_trans_handle = state.task;
+    rf_rmt->tx_final = false;
+
+    static RFLoopbackLoad load;
+    load.critical_us = loopback->load_critical_us;
+    load.stop = false;
+    load.running = 0;
+    portMUX_INITIALIZE(&load.lock);
+    for (uint8_t i = 0; i < loopback->load_tasks; i++) {
+        if (xTaskCreatePinnedToCore(loopback_load_task, "rf_load", 2048, &load, tskIDLE_PRIORITY + 1, NULL,
+                i % portNUM_PROCESSORS) == pdPASS)
+            load.running++;
+    }
+
+    RFSelftestConfig run = *config;
+    run.send = loopback_send;
+    run.ctx = &state;
+    rf_selftest_run(&run, result);
+
+    load.stop = true;
+    while (__atomic_load_n(&load.running, __ATOMIC_ACQUIRE)) vTaskDelay(1);
+
+    rf_rmt->rx = rx;
+    rf_rmt->rf_trans_handle = notify;
+    rf_rmt->tx_final = final;
+    ESP_LOGI(TAG, "Loopback self-test: %lu of %lu transmissions decoded", result->decoded, result->transmissions);
+
+err_enabled:
+    rmt_disable(state.rx_chan);
+err:
+    if (state.rx_chan) rmt_del_channel(state.rx_chan);
+    heap_caps_free(state.symbols);
+    state.symbols = NULL;
+    if (capture_gpio == rf_rmt->tx_gpio) gpio_set_direction(capture_gpio, GPIO_MODE_OUTPUT);
+    return ret;
+}
@@ -0,0 +1,26 @@
+#ifndef RF_LOOPBACK_H
+#define RF_LOOPBACK_H
+
+/* On-device runner of the TX timing self-test. Only built with CONFIG_RF_SELFTEST, so it stays out of
+rf_common.h and pulls the simulator headers in for its users alone */
+
+#include "rf_common.h"
+#include "rf_selftest.h"
+
+#define RF_LOOPBACK_TIMEOUT_MS 2000
+#define RF_LOOPBACK_LOAD_BUSY_US 200
+#define RF_LOOPBACK_BUFFER_SYMBOLS (RF_SELFTEST_MAX_EDGES / 2 + 1)
+
+typedef struct {
+    gpio_num_t capture_gpio;    // Input wired to the TX pin, GPIO_NUM_NC captures on the TX pin itself
+    uint8_t load_tasks;         // Tasks loading the CPUs during the test, 0 for none
+    uint16_t load_critical_us;  // Interrupts held off per load iteration, like a flash write would
+} RFLoopbackConfig;
+
+/* Run the TX timing self-test (see rf_selftest.h) on the GPTimer engine. An RMT RX channel on the capture
+pin timestamps the edges in hardware. The send callback and context in config are replaced. The receiver
+and task notification of the transmitter are detached for the duration */
+esp_err_t rf_loopback_run(RFTransmitter* rf_rmt, const RFLoopbackConfig* loopback, const RFSelftestConfig* config,
+    RFSelftestResult* result);
+
+#endif // RF_LOOPBACK_H
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+RFMetrics rf_metrics_shards[portNUM_PROCESSORS];
+
+static esp_timer_handle_t dump_timer = NULL;
+
+static const char* metric_names[RF_METRIC_COUNT] = {
+    "edges", "gaps", "frames", "short_frames", "edge_overflows", "unclassified", "pool_overflows", "glitches", "mutes",
+    "echoes", "tx_sends",
+};
+
+static const char* hist_names[RF_HIST_COUNT] = {
+    "isr_cycles", "tx_send_us", "tx_lateness", "tx_boundary",
+};
+
+void rf_metrics_snapshot(RFMetrics* snapshot) {
+    memset(snapshot, 0, sizeof(RFMetrics));
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+        const RFMetrics* shard = &rf_metrics_shards[core];
+        for (uint8_t i = 0; i < RF_METRIC_COUNT; i++)
+            snapshot->counters[i] += __atomic_load_n(&shard->counters[i], __ATOMIC_RELAXED);
+        for (uint8_t i = 0; i < RF_MAX_PROTOCOLS; i++) {
+            snapshot->proto_match[i] += __atomic_load_n(&shard->proto_match[i], __ATOMIC_RELAXED);
+            snapshot->proto_reject[i] += __atomic_load_n(&shard->proto_reject[i], __ATOMIC_RELAXED);
+        }
+        for (uint8_t h = 0; h < RF_HIST_COUNT; h++) {
+            for (uint8_t b = 0; b < RF_METRICS_BUCKETS; b++)
+                snapshot->hist[h][b] += __atomic_load_n(&shard->hist[h][b], __ATOMIC_RELAXED);
+            const uint32_t max = __atomic_load_n(&shard->hist_max[h], __ATOMIC_RELAXED);
+            if (max > snapshot->hist_max[h]) snapshot->hist_max[h] = max;
+        }
+    }
+}
+
+void rf_metrics_reset(void) {
+    // Racing increments may survive the reset, which only matters for the first dump after it
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t* words = (uint32_t*)&rf_metrics_shards[core];
+        for (size_t i = 0; i < sizeof(RFMetrics) / sizeof(uint32_t); i++)
+            __atomic_store_n(&words[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void rf_metrics_dump(const RFMetrics* snapshot) {
+    char line[256];
+    int len = 0;
+    for (uint8_t i = 0; i < RF_METRIC_COUNT && len < (int)sizeof(line); i++)
+        len += snprintf(&line[len], sizeof(line) - len, "%s=%lu ", metric_names[i], snapshot->counters[i]);
+    ESP_LOGI(TAG, "Metrics: %s", line);
+
+    for (uint8_t i = 0; i < rf_proto_count(); i++) {
+        if (snapshot->proto_match[i] || snapshot->proto_reject[i])
+            ESP_LOGI(TAG, "Protocol %d: %lu matched, %lu rejected", i + 1, snapshot->proto_match[i], snapshot->proto_reject[i]);
+    }
+
+    for (uint8_t h = 0; h < RF_HIST_COUNT; h++) {
+        len = 0;
+        for (uint8_t b = 0; b < RF_METRICS_BUCKETS && len < (int)sizeof(line); b++)
+            len += snprintf(&line[len], sizeof(line) - len, "%lu ", snapshot->hist[h][b]);
+        ESP_LOGI(TAG, "%s (max %lu): %s", hist_names[h], snapshot->hist_max[h], line);
+    }
+}
+
+static void dump_callback(void* arg) {
+    static RFMetrics snapshot;
+    rf_metrics_snapshot(&snapshot);
+    rf_metrics_dump(&snapshot);
+}
+
+esp_err_t rf_metrics_start_dump(uint32_t period_ms) {
+    if (dump_timer) {
+        esp_timer_stop(dump_timer);
+        ESP_RETURN_ON_ERROR(esp_timer_delete(dump_timer), TAG, "Failed to delete metrics timer");
+        dump_timer = NULL;
+    }
+    if (period_ms == 0) return ESP_OK;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = dump_callback,
+        .name = "rf_metrics",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &dump_timer), TAG, "Failed to create metrics timer");
+    return esp_timer_start_periodic(dump_timer, (uint64_t)period_ms * 1000);
+}
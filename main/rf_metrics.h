@@ -0,0 +1,87 @@
+#ifndef RF_METRICS_H
+#define RF_METRICS_H
+
+/* ISR-safe counters and histograms. Every core writes its own shard with relaxed atomics,
+so recording costs a core id read and one uncontended add. Readers sum the shards */
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include "rf_core.h"
+
+#define RF_METRICS_BUCKETS 16
+
+typedef enum {
+    RF_METRIC_EDGES,           // Edges seen by the receiver ISRs
+    RF_METRIC_GAPS,            // Edges longer than the separation limit, each one gates a frame
+    RF_METRIC_FRAMES,          // Timing frames handed to the decoder
+    RF_METRIC_SHORT_FRAMES,    // Frames rejected with fewer than RF_MIN_FRAME_EDGES edges
+    RF_METRIC_EDGE_OVERFLOWS,  // Frames discarded for running past MAX_EDGES
+    RF_METRIC_UNCLASSIFIED,    // Frames no protocol signature fits
+    RF_METRIC_POOL_OVERFLOWS,  // Frames dropped because the decoder was behind
+    RF_METRIC_GLITCHES,        // Pulses shorter than the receiver's minimum pulse
+    RF_METRIC_MUTES,           // Times a receiver muted its pin for exceeding the edge rate
+    RF_METRIC_ECHOES,          // Edges dropped as the echo of our own transmission
+    RF_METRIC_TX_SENDS,
+    RF_METRIC_COUNT,
+} RFMetric;
+
+typedef enum {
+    RF_HIST_ISR_CYCLES,        // Receiver ISR duration in CPU cycles
+    RF_HIST_TX_SEND_US,        // rf_send to the end of the last repeat
+    RF_HIST_TX_LATENESS,       // Timer ticks between a TX alarm and its callback
+    RF_HIST_TX_BOUNDARY,       // Ticks a repeat started after its place in the absolute schedule
+    RF_HIST_COUNT,
+} RFHistogram;
+
+// Bucket i counts values in [2^(i-1), 2^i), bucket 0 counts zeros, the last bucket is open ended
+typedef struct {
+    uint32_t counters[RF_METRIC_COUNT];
+    uint32_t proto_match[RF_MAX_PROTOCOLS];
+    uint32_t proto_reject[RF_MAX_PROTOCOLS];
+    uint32_t hist[RF_HIST_COUNT][RF_METRICS_BUCKETS];
+    uint32_t hist_max[RF_HIST_COUNT];
+} RFMetrics;
+
+extern RFMetrics rf_metrics_shards[portNUM_PROCESSORS];
+
+static inline RFMetrics* rf_metrics_shard(void) {
+    return &rf_metrics_shards[esp_cpu_get_core_id()];
+}
+
+static inline void rf_metrics_add(RFMetric metric, uint32_t value) {
+    __atomic_fetch_add(&rf_metrics_shard()->counters[metric], value, __ATOMIC_RELAXED);
+}
+
+static inline void rf_metrics_inc(RFMetric metric) {
+    rf_metrics_add(metric, 1);
+}
+
+static inline void rf_metrics_proto(uint8_t proto, bool match) {
+    RFMetrics* shard = rf_metrics_shard();
+    __atomic_fetch_add(match ? &shard->proto_match[proto] : &shard->proto_reject[proto], 1, __ATOMIC_RELAXED);
+}
+
+static inline void rf_metrics_record(RFHistogram hist, uint32_t value) {
+    RFMetrics* shard = rf_metrics_shard();
+    uint32_t bucket = value ? 32 - __builtin_clz(value) : 0;
+    if (bucket >= RF_METRICS_BUCKETS) bucket = RF_METRICS_BUCKETS - 1;
+    __atomic_fetch_add(&shard->hist[hist][bucket], 1, __ATOMIC_RELAXED);
+    // An ISR may record on the same shard in between, only a larger value replaces the max
+    uint32_t max = __atomic_load_n(&shard->hist_max[hist], __ATOMIC_RELAXED);
+    while (value > max && !__atomic_compare_exchange_n(&shard->hist_max[hist], &max, value, true,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// Sum of every shard, counters keep running while it is taken
+void rf_metrics_snapshot(RFMetrics* snapshot);
+
+void rf_metrics_reset(void);
+
+void rf_metrics_dump(const RFMetrics* snapshot);
+
+// Log a snapshot every period_ms, 0 stops the periodic dump
+esp_err_t rf_metrics_start_dump(uint32_t period_ms);
+
+#endif // RF_METRICS_H
@@ -0,0 +1,39 @@
+#include <string.h>
+#include "rf_core.h"
+
+static inline bool ticks_valid(const Protocol* proto, RFTicks ticks) {
+    return ticks.high && ticks.low &&
+        (uint32_t)ticks.high * proto->pulse_length <= RF_PULSE_MAX_TICKS &&
+        (uint32_t)ticks.low * proto->pulse_length <= RF_PULSE_MAX_TICKS;
+}
+
+bool rf_proto_valid(const Protocol* proto) {
+    return proto && proto->pulse_length &&
+        ticks_valid(proto, proto->sync_factor) && ticks_valid(proto, proto->zero) && ticks_valid(proto, proto->one);
+}
+
+void rf_proto_compile(const Protocol* proto, RFProtoTiming* timing) {
+    const uint32_t sync_len = proto->sync_factor.low > proto->sync_factor.high ? proto->sync_factor.low : proto->sync_factor.high;
+    timing->sync_recip = (65536 + sync_len - 1) / sync_len;
+    timing->zero = proto->zero;
+    timing->one = proto->one;
+    timing->inverted = proto->inverted;
+}
+
+uint8_t rf_proto_parse_blob(const uint8_t* blob, size_t len, Protocol* out, uint8_t max) {
+    if (!blob || len < RF_PROTO_BLOB_HEADER || memcmp(blob, "RFP", 3) != 0 || blob[3] != RF_PROTO_BLOB_VERSION) return 0;
+    const uint8_t count = blob[4];
+    if (count > max || len != RF_PROTO_BLOB_HEADER + (size_t)count * RF_PROTO_BLOB_RECORD) return 0;
+
+    const uint8_t* rec = blob + RF_PROTO_BLOB_HEADER;
+    for (uint8_t i = 0; i < count; i++, rec += RF_PROTO_BLOB_RECORD) {
+        Protocol* p = &out[i];
+        p->pulse_length = rec[0] | (uint16_t)rec[1] << 8;
+        p->sync_factor = (RFTicks){ rec[2], rec[3] };
+        p->zero = (RFTicks){ rec[4], rec[5] };
+        p->one = (RFTicks){ rec[6], rec[7] };
+        p->inverted = rec[8] & 1;
+        if (!rf_proto_valid(p)) return 0;
+    }
+    return count;
+}
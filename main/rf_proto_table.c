@@ -0,0 +1,99 @@
+#include <string.h>
+#include "rf_common.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+// Built-in protocols first, runtime registrations appended. Entries never move so indices stay valid
+static Protocol proto_table[RF_MAX_PROTOCOLS];
+static RFSymbolTable proto_symbols[RF_MAX_PROTOCOLS];
+static uint8_t proto_table_count = 0;
+static bool proto_table_ready = false;
+static portMUX_TYPE proto_table_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void proto_table_init(void) {
+    if (__atomic_load_n(&proto_table_ready, __ATOMIC_ACQUIRE)) return;
+
+    // Built outside the lock, a racing caller builds its own copy and the first one in publishes
+    RFSymbolTable symbols[PROTO_COUNT];
+    for (uint8_t i = 0; i < PROTO_COUNT; i++)
+        rf_symbol_table_build(&proto[i], &symbols[i]);
+
+    portENTER_CRITICAL(&proto_table_lock);
+    if (!proto_table_ready) {
+        memcpy(proto_table, proto, sizeof(proto));
+        memcpy(proto_symbols, symbols, sizeof(symbols));
+        proto_table_count = PROTO_COUNT;
+        __atomic_store_n(&proto_table_ready, true, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&proto_table_lock);
+}
+
+const Protocol* rf_protos(void) {
+    proto_table_init();
+    return proto_table;
+}
+
+uint8_t rf_proto_count(void) {
+    proto_table_init();
+    return __atomic_load_n(&proto_table_count, __ATOMIC_ACQUIRE);
+}
+
+const Protocol* rf_proto_get(uint8_t idx) {
+    return idx < rf_proto_count() ? &proto_table[idx] : NULL;
+}
+
+const RFSymbolTable* rf_proto_symbols(uint8_t idx) {
+    return idx < rf_proto_count() ? &proto_symbols[idx] : NULL;
+}
+
+esp_err_t rf_proto_register(const Protocol* protocol, uint8_t* idx) {
+    ESP_RETURN_ON_FALSE(rf_proto_valid(protocol), ESP_ERR_INVALID_ARG, TAG, "Invalid protocol");
+    proto_table_init();
+
+    // Built outside the lock, only the copy and the count that publishes the entry to readers are inside
+    RFSymbolTable symbols;
+    rf_symbol_table_build(protocol, &symbols);
+
+    portENTER_CRITICAL(&proto_table_lock);
+    const uint8_t slot = proto_table_count;
+    if (slot < RF_MAX_PROTOCOLS) {
+        proto_table[slot] = *protocol;
+        proto_symbols[slot] = symbols;
+        __atomic_store_n(&proto_table_count, slot + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&proto_table_lock);
+    ESP_RETURN_ON_FALSE(slot < RF_MAX_PROTOCOLS, ESP_ERR_NO_MEM, TAG, "Protocol table is full");
+
+    if (idx) *idx = slot;
+    ESP_LOGI(TAG, "Protocol %d registered (pulse length %d)", slot + 1, protocol->pulse_length);
+    return ESP_OK;
+}
+
+esp_err_t rf_proto_load_blob(const uint8_t* blob, size_t len, uint8_t* first_idx) {
+    Protocol protos[RF_MAX_PROTOCOLS];
+    const uint8_t count = rf_proto_parse_blob(blob, len, protos, RF_MAX_PROTOCOLS);
+    ESP_RETURN_ON_FALSE(count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid protocol blob");
+    ESP_RETURN_ON_FALSE(rf_proto_count() + count <= RF_MAX_PROTOCOLS, ESP_ERR_NO_MEM, TAG, "Protocol table is full");
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t idx;
+        ESP_RETURN_ON_ERROR(rf_proto_register(&protos[i], &idx), TAG, "Failed to register protocol");
+        if (i == 0 && first_idx) *first_idx = idx;
+    }
+    return ESP_OK;
+}
+
+esp_err_t rf_proto_load_nvs(const char* nvs_namespace, const char* key, uint8_t* first_idx) {
+    ESP_RETURN_ON_FALSE(nvs_namespace && key, ESP_ERR_INVALID_ARG, TAG, "Invalid NVS key");
+
+    uint8_t blob[RF_PROTO_BLOB_HEADER + RF_MAX_PROTOCOLS * RF_PROTO_BLOB_RECORD];
+    size_t len = sizeof(blob);
+    nvs_handle_t nvs;
+    ESP_RETURN_ON_ERROR(nvs_open(nvs_namespace, NVS_READONLY, &nvs), TAG, "Failed to open NVS namespace %s", nvs_namespace);
+    const esp_err_t err = nvs_get_blob(nvs, key, blob, &len);
+    nvs_close(nvs);
+    ESP_RETURN_ON_ERROR(err, TAG, "Failed to read protocol blob %s", key);
+
+    return rf_proto_load_blob(blob, len, first_idx);
+}
@@ -1,88 +1,419 @@
+#include <stdio.h>
 #include <string.h>
 #include "rf_common.h"
 #include "esp_check.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_cpu.h"
+#include "rf_metrics.h"
+
+typedef struct {
+    RFReceiver* rf_recv;
+    uint8_t kind;
+    uint8_t idx;
+} RFDecodeJob;
+
+// One decoder task and one GPIO ISR service serve every receiver
+static QueueHandle_t decode_queue = NULL;
+static TaskHandle_t rf_decode_handle = NULL;
+static UBaseType_t decoder_prio = RF_DECODER_TASK_PRIO;
+static BaseType_t decoder_core = RF_DECODER_TASK_CORE;
+static uint8_t receiver_count = 0;
+// Registries may be shared and are fed from ISRs in stream mode
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Hand a decoded frame to the application, the registry collapses repeats first. False when nothing was queued
+static bool IRAM_ATTR recv_publish(RFReceiver* rf_recv, RFRecvFrame* frame) {
+    frame->rx_id = rf_recv->id;
+    frame->event = RF_RECV_EVENT_FRAME;
+    frame->handle = 0;
+    rf_metrics_proto(frame->proto, true);
+
+    RFRegistry* registry = rf_recv->recv_registry;
+    if (registry) {
+        portENTER_CRITICAL_SAFE(&registry_lock);
+        const bool deliver = rf_registry_feed(registry, frame);
+        portEXIT_CRITICAL_SAFE(&registry_lock);
+        if (!deliver) return false;
+    }
+
+    if (!rf_ring_push(&rf_recv->recv_ring, frame)) return false;
+    rf_recv->recv_frames++;
+    return rf_recv->rf_recv_handle != NULL;
+}
 
-static inline uint32_t diff(uint32_t a, uint32_t b) {
-    return (a > b) ? (a - b) : (b - a);
-}
-
-static bool IRAM_ATTR recv_proto(RFTransmitter* rf_rmt, uint8_t proto_idx, uint32_t edge_count) {
-    const Protocol curr_proto = proto[proto_idx];
-
-    uint32_t code = 0;
-    const uint32_t sync_len_in_pulses = curr_proto.sync_factor.low > curr_proto.sync_factor.high
-        ? curr_proto.sync_factor.low : curr_proto.sync_factor.high;
-    const uint32_t delay = rf_rmt->recv_timings[0] / sync_len_in_pulses;
-    const uint32_t delay_tolerance = delay * rf_rmt->recv_tolerance / 100;
-
-    const uint8_t first_data_timing = curr_proto.inverted ? 2 : 1;
-    for (uint8_t i = first_data_timing; i < edge_count - 1; i += 2) {
-        code <<= 1;
-        if (diff(rf_rmt->recv_timings[i], delay * curr_proto.zero.high) < delay_tolerance &&
-                diff(rf_rmt->recv_timings[i + 1], delay * curr_proto.zero.low) < delay_tolerance) {
-            code |= 0;
-        } else if (diff(rf_rmt->recv_timings[i], delay * curr_proto.one.high) < delay_tolerance &&
-                diff(rf_rmt->recv_timings[i + 1], delay * curr_proto.one.low) < delay_tolerance) {
-            code |= 1;
-        } else {
-            return false;
+static void recv_decode(RFReceiver* rf_recv, const uint32_t* timings, uint32_t edge_count, int64_t timestamp) {
+    RFRecvFrame frame;
+    uint32_t rejected = 0;
+    if (edge_count < RF_MIN_FRAME_EDGES) {
+        rf_metrics_inc(RF_METRIC_SHORT_FRAMES);
+    } else if (rf_recv->recv_calibrate ? rf_decode_calibrated(&rf_recv->recv_calib, &rf_recv->recv_index, rf_protos(),
+            timings, edge_count, rf_recv->recv_tolerance, &frame, &rejected) :
+            rf_decode_batch(&rf_recv->recv_index, rf_protos(), timings, edge_count, rf_recv->recv_tolerance, &frame, &rejected)) {
+        frame.timestamp = timestamp;
+        if (recv_publish(rf_recv, &frame))
+            xTaskNotifyGive(rf_recv->rf_recv_handle);
+    } else if (!rejected) {
+        rf_metrics_inc(RF_METRIC_UNCLASSIFIED);
+    }
+    for (uint8_t i = 0; rejected; i++, rejected >>= 1)
+        if (rejected & 1) rf_metrics_proto(i, false);
+}
+
+static void rf_decoder_task(void* arg) {
+    RFDecodeJob job;
+
+    while (1) {
+        if (xQueueReceive(decode_queue, &job, portMAX_DELAY) != pdTRUE) continue;
+        RFReceiver* rf_recv = job.rf_recv;
+
+        if (job.kind == RF_DECODE_JOB_RMT) {
+            rf_rmt_rx_process(rf_recv, job.idx);
+            continue;
         }
+
+        const RFTimingFrame* timing = &rf_recv->recv_pool[job.idx];
+        recv_decode(rf_recv, timing->timings, timing->edge_count, timing->timestamp);
+
+        // Hand the buffer back to the ISR
+        __atomic_fetch_and(&rf_recv->recv_pool_busy, ~(1UL << job.idx), __ATOMIC_RELEASE);
     }
+}
+
+bool IRAM_ATTR rf_recv_post_from_isr(RFReceiver* rf_recv, uint8_t kind, uint8_t idx, BaseType_t* xHigherPriorityTaskWoken) {
+    const RFDecodeJob job = {
+        .rf_recv = rf_recv,
+        .kind = kind,
+        .idx = idx,
+    };
+    return xQueueSendFromISR(decode_queue, &job, xHigherPriorityTaskWoken) == pdTRUE;
+}
+
+// Reset everything that spans edges, the edges missed while muted or paused break any frame in progress
+static void IRAM_ATTR recv_frontend_reset(RFReceiver* rf_recv) {
+    rf_framer_reset(&rf_recv->recv_framer, rf_recv->separation_limit);
+    rf_glitch_reset(&rf_recv->recv_glitch, rf_recv->recv_min_pulse);
+    rf_rate_limit_reset(&rf_recv->recv_limit, RF_RECV_RATE_WINDOW, rf_recv->recv_max_edges);
+    if (rf_recv->recv_mode == RF_DECODE_STREAM)
+        rf_stream_reset(&rf_recv->recv_stream);
+}
+
+void IRAM_ATTR rf_recv_echo_begin(RFReceiver* rf_recv, uint32_t schedule_us) {
+    // Bounded by the schedule so a lost completion cannot gate the receiver for good
+    const uint32_t now = (uint32_t)esp_timer_get_time();
+    rf_recv->recv_echo_end = now + schedule_us + schedule_us / 8 + RF_ECHO_GUARD_US;
+    rf_recv->recv_echo_start = now;
+}
 
-    // Ignore very short transmissions (Presumably noise)
-    if (edge_count > 7) {
-        rf_rmt->recv_value = code;
-        rf_rmt->recv_bit_length = (edge_count - 1) / 2;
-        rf_rmt->recv_delay = delay;
-        rf_rmt->recv_proto = proto_idx;
+void IRAM_ATTR rf_recv_echo_end(RFReceiver* rf_recv) {
+    rf_recv->recv_echo_end = (uint32_t)esp_timer_get_time() + RF_ECHO_GUARD_US;
+}
+
+/* Drop edges inside the echo window. The frame state they broke is reset on the first edge
+after the window, which then carries the whole gap and starts the next frame cleanly */
+static inline bool IRAM_ATTR recv_echo_gated(RFReceiver* rf_recv, int64_t time) {
+    const uint32_t t = (uint32_t)time, start = rf_recv->recv_echo_start, end = rf_recv->recv_echo_end;
+    // Edges from before the window opened pass, they must not close it either
+    if (start == end || (int32_t)(t - start) < 0) return false;
+    if (t - start < end - start) {
+        rf_recv->recv_echo_resync = true;
+        rf_metrics_inc(RF_METRIC_ECHOES);
         return true;
     }
-
+    // Expired: collapse the window even when it gated nothing, the 32-bit times would bring it back after wrapping
+    rf_recv->recv_echo_start = end;
+    if (rf_recv->recv_echo_resync) {
+        rf_recv->recv_echo_resync = false;
+        recv_frontend_reset(rf_recv);
+    }
     return false;
 }
 
-static void IRAM_ATTR rf_recv_isr_handler(void* arg) {
-    RFTransmitter* rf_rmt = (RFTransmitter*)arg;
-
-    static uint32_t edge_count = 0;
-    static uint64_t last_time = 0;
-    static uint32_t repeat_count = 0;
-
-    const int64_t time = esp_timer_get_time();
-    const uint32_t duration = (uint32_t)(time - last_time);
-
-    if (duration > rf_rmt->separation_limit) {
-        // Long stretch without signal level change -> presumably the gap between two transmissions
-        if ((repeat_count == 0) || (diff(duration, rf_rmt->recv_timings[0]) < 200)) {
-            /* Assuming the sender sending the signal multiple times with roughly the same gap period, 
-            this long signal is close in length to the signal which start the previous records
-            -> potentially confirming it being a gap between two transmissions */
-            repeat_count++;
-            if (repeat_count == 2) {
-                for (uint8_t i = 0; i < PROTO_COUNT; i++)
-                    if (recv_proto(rf_rmt, i, edge_count)) break;
-                repeat_count = 0;
-            }
+void rf_recv_feed_edge(RFReceiver* rf_recv, uint32_t duration, int64_t time) {
+    rf_metrics_inc(RF_METRIC_EDGES);
+    if (recv_echo_gated(rf_recv, time)) return;
+    if (rf_recv->recv_glitch.min_pulse) {
+        const uint32_t raw = duration;
+        if (raw < rf_recv->recv_glitch.min_pulse) rf_metrics_inc(RF_METRIC_GLITCHES);
+        if (!rf_glitch_feed(&rf_recv->recv_glitch, raw, &duration)) return;
+        time -= raw;
+    }
+    if (duration > rf_recv->separation_limit) rf_metrics_inc(RF_METRIC_GAPS);
+
+    if (rf_recv->recv_mode == RF_DECODE_STREAM) {
+        RFRecvFrame frame;
+        if (rf_stream_feed(&rf_recv->recv_stream, duration, time, &frame) && recv_publish(rf_recv, &frame))
+            xTaskNotifyGive(rf_recv->rf_recv_handle);
+        return;
+    }
+
+    // Only the decoder task feeds edges here, one frame buffer is enough
+    uint32_t* timings = rf_recv->recv_pool[0].timings;
+    if (rf_framer_closes(&rf_recv->recv_framer, timings, duration)) {
+        rf_metrics_inc(RF_METRIC_FRAMES);
+        recv_decode(rf_recv, timings, rf_recv->recv_framer.edge_count, time - duration);
+    }
+    if (!rf_framer_push(&rf_recv->recv_framer, timings, duration))
+        rf_metrics_inc(RF_METRIC_EDGE_OVERFLOWS);
+}
+
+// Queue the filled timing frame for decoding and switch the ISR to a free buffer
+static void IRAM_ATTR recv_handoff(RFReceiver* rf_recv, int64_t timestamp, BaseType_t* xHigherPriorityTaskWoken) {
+    const uint32_t busy = __atomic_load_n(&rf_recv->recv_pool_busy, __ATOMIC_ACQUIRE);
+    uint8_t next = rf_recv->recv_fill;
+    for (uint8_t i = 1; i < RF_FRAME_POOL_SIZE; i++) {
+        const uint8_t candidate = (rf_recv->recv_fill + i) % RF_FRAME_POOL_SIZE;
+        if (!(busy & (1UL << candidate))) {
+            next = candidate;
+            break;
         }
+    }
+
+    // Decoder is behind on every buffer, drop this frame and keep capturing in place
+    if (next == rf_recv->recv_fill) {
+        rf_recv->recv_pool_overflows++;
+        rf_metrics_inc(RF_METRIC_POOL_OVERFLOWS);
+        return;
+    }
 
-        edge_count = 0;
+    const uint8_t idx = rf_recv->recv_fill;
+    rf_recv->recv_pool[idx].edge_count = rf_recv->recv_framer.edge_count;
+    rf_recv->recv_pool[idx].timestamp = timestamp;
+    __atomic_fetch_or(&rf_recv->recv_pool_busy, 1UL << idx, __ATOMIC_RELEASE);
+    if (!rf_recv_post_from_isr(rf_recv, RF_DECODE_JOB_FRAME, idx, xHigherPriorityTaskWoken)) {
+        __atomic_fetch_and(&rf_recv->recv_pool_busy, ~(1UL << idx), __ATOMIC_RELEASE);
+        rf_recv->recv_pool_overflows++;
+        rf_metrics_inc(RF_METRIC_POOL_OVERFLOWS);
+        return;
+    }
+    rf_recv->recv_fill = next;
+    rf_metrics_inc(RF_METRIC_FRAMES);
+}
+
+// Compile the protocol table as it is now into the receiver's decoders
+static void recv_protocols_build(RFReceiver* rf_recv) {
+    const uint8_t count = rf_proto_count();
+    rf_proto_index_build_mask(&rf_recv->recv_index, rf_protos(), count, rf_recv->recv_protocols);
+    rf_stream_init(&rf_recv->recv_stream, rf_protos(), count, rf_recv->recv_tolerance,
+        rf_recv->separation_limit, rf_recv->recv_confirm);
+    rf_stream_enable(&rf_recv->recv_stream, rf_recv->recv_protocols);
+}
+
+// Noise storm: stop taking edge interrupts until the re-arm timer fires
+static void IRAM_ATTR recv_mute(RFReceiver* rf_recv) {
+    if (rf_recv->recv_muted) return;
+    rf_recv->recv_muted = true;
+    gpio_intr_disable(rf_recv->rx_gpio);
+    esp_timer_start_once(rf_recv->recv_rearm, rf_recv->recv_mute_us);
+    rf_metrics_inc(RF_METRIC_MUTES);
+}
+
+static void recv_rearm_callback(void* arg) {
+    RFReceiver* rf_recv = (RFReceiver*)arg;
+    if (!rf_recv->recv_muted || rf_recv->rx_gpio == GPIO_NUM_NC) return;
+    if (rf_recv->recv_backend == RF_RX_BACKEND_RMT) {
+        // The decoder task starts over on the next chunk, the ones taken while muted were dropped
+        rf_recv->recv_muted = false;
+        return;
+    }
+
+    // The ISR is quiet while muted, its state can be reset from here
+    recv_frontend_reset(rf_recv);
+    rf_recv->last_time = esp_timer_get_time();
+    rf_recv->recv_level = gpio_get_level(rf_recv->rx_gpio);
+    rf_recv->recv_muted = false;
+    gpio_intr_enable(rf_recv->rx_gpio);
+}
+
+static void IRAM_ATTR rf_recv_isr_handler(void* arg) {
+    const uint32_t start_cycles = esp_cpu_get_cycle_count();
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    RFReceiver* rf_recv = (RFReceiver*)arg;
+
+    const int64_t now = esp_timer_get_time();
+    uint32_t duration = (uint32_t)(now - rf_recv->last_time);
+    rf_recv->last_time = now;
+    rf_metrics_inc(RF_METRIC_EDGES);
+
+    if (rf_recv->recv_sniff.buf) rf_trace_ring_push(&rf_recv->recv_sniff, rf_recv->recv_level, duration);
+    rf_recv->recv_level ^= 1;
+    if (recv_echo_gated(rf_recv, now)) goto done;
+
+    if (rf_rate_limit_feed(&rf_recv->recv_limit, now)) {
+        recv_mute(rf_recv);
+        goto done;
+    }
+
+    // The glitch filter releases the duration that ended one edge ago
+    int64_t time = now;
+    if (rf_recv->recv_glitch.min_pulse) {
+        const uint32_t raw = duration;
+        if (raw < rf_recv->recv_glitch.min_pulse) rf_metrics_inc(RF_METRIC_GLITCHES);
+        if (!rf_glitch_feed(&rf_recv->recv_glitch, raw, &duration)) goto done;
+        time = now - raw;
+    }
+    if (duration > rf_recv->separation_limit) rf_metrics_inc(RF_METRIC_GAPS);
+
+    if (rf_recv->recv_mode == RF_DECODE_STREAM) {
+        RFRecvFrame frame;
+        if (rf_stream_feed(&rf_recv->recv_stream, duration, time, &frame) && recv_publish(rf_recv, &frame))
+            vTaskNotifyGiveFromISR(rf_recv->rf_recv_handle, &xHigherPriorityTaskWoken);
+        goto done;
     }
 
-    if (edge_count >= MAX_EDGES) {
-        edge_count = 0;
-        repeat_count = 0;
+    uint32_t* timings = rf_recv->recv_pool[rf_recv->recv_fill].timings;
+
+    if (rf_framer_closes(&rf_recv->recv_framer, timings, duration)) {
+        recv_handoff(rf_recv, time - duration, &xHigherPriorityTaskWoken);
+        timings = rf_recv->recv_pool[rf_recv->recv_fill].timings;
+    }
+    if (!rf_framer_push(&rf_recv->recv_framer, timings, duration))
+        rf_metrics_inc(RF_METRIC_EDGE_OVERFLOWS);
+
+done:;
+    const uint32_t isr_cycles = esp_cpu_get_cycle_count() - start_cycles;
+    if (isr_cycles > rf_recv->recv_isr_max_cycles) rf_recv->recv_isr_max_cycles = isr_cycles;
+    rf_recv->recv_isr_cycles += isr_cycles;
+    rf_recv->recv_isr_calls++;
+    rf_metrics_record(RF_HIST_ISR_CYCLES, isr_cycles);
+
+    if (xHigherPriorityTaskWoken == pdTRUE) portYIELD_FROM_ISR();
+}
+
+// The last receiver gone takes the decoder task and queue with it
+static void recv_release_shared(void) {
+    if (--receiver_count == 0) {
+        vTaskDelete(rf_decode_handle);
+        rf_decode_handle = NULL;
+        vQueueDelete(decode_queue);
+        decode_queue = NULL;
+        gpio_uninstall_isr_service();
+        ESP_LOGI(TAG, "Decoder task deleted");
+    }
+}
+
+esp_err_t rf_recv_create(uint8_t id, RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(receiver_count < RF_MAX_RECEIVERS, ESP_ERR_NO_MEM, TAG, "Too many RF receivers");
+
+    if (receiver_count == 0) {
+        // The application may have installed the ISR service already
+        esp_err_t err = gpio_install_isr_service(0);
+        ESP_RETURN_ON_FALSE(err == ESP_OK || err == ESP_ERR_INVALID_STATE, err, TAG, "Failed to install ISR service");
+        ESP_LOGI(TAG, "ISR service installed");
+
+        decode_queue = xQueueCreate(RF_MAX_RECEIVERS * RF_FRAME_POOL_SIZE, sizeof(RFDecodeJob));
+        ESP_RETURN_ON_FALSE(decode_queue, ESP_ERR_NO_MEM, TAG, "Failed to create decode queue");
+        if (xTaskCreatePinnedToCore(rf_decoder_task, "rf_decoder", RF_DECODER_TASK_STACK, NULL,
+                decoder_prio, &rf_decode_handle, decoder_core) != pdPASS) {
+            vQueueDelete(decode_queue);
+            decode_queue = NULL;
+            rf_decode_handle = NULL;
+            ESP_LOGE(TAG, "Failed to create decoder task");
+            return ESP_ERR_NO_MEM;
+        }
+        ESP_LOGI(TAG, "Decoder task created");
+    }
+    receiver_count++;
+
+    memset(rf_recv, 0, sizeof(RFReceiver));
+    rf_recv->id = id;
+    rf_recv->rx_gpio = GPIO_NUM_NC;
+    rf_recv->rx_gpio_state = GPIO_NUM_NC;
+    rf_recv->separation_limit = SEPARATION_LIMIT;
+    rf_recv->recv_tolerance = RECV_TOLERANCE;
+    rf_recv->recv_mode = RF_DECODE_BATCH;
+    rf_recv->recv_max_edges = (uint64_t)RF_RECV_MAX_EDGE_RATE * RF_RECV_RATE_WINDOW / 1000000;
+    rf_recv->recv_mute_us = RF_RECV_MUTE_US;
+    rf_recv->recv_calibrate = false;
+    rf_recv->recv_registry = NULL;
+    rf_recv->recv_protocols = UINT32_MAX;
+    rf_ring_reset(&rf_recv->recv_ring);
+
+    const esp_timer_create_args_t rearm_args = {
+        .callback = recv_rearm_callback,
+        .arg = rf_recv,
+        .name = "rf_recv_rearm",
+    };
+    esp_err_t err = esp_timer_create(&rearm_args, &rf_recv->recv_rearm);
+    if (err != ESP_OK) {
+        recv_release_shared();
+        ESP_LOGE(TAG, "Failed to create re-arm timer");
+        return err;
     }
 
-    rf_rmt->recv_timings[edge_count++] = duration;
-    last_time = (uint64_t)time;
+    rf_recv->init = true;
+    ESP_LOGI(TAG, "RF receiver %d created", id);
+    return ESP_OK;
+}
+
+esp_err_t rf_recv_destroy(RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+
+    if (rf_recv->rx_gpio != GPIO_NUM_NC)
+        ESP_ERROR_CHECK(rf_recv_deinit(rf_recv, false));
+
+    // Let the decoder finish any frame it holds from this receiver
+    while (__atomic_load_n(&rf_recv->recv_pool_busy, __ATOMIC_ACQUIRE))
+        vTaskDelay(1);
+    rf_recv->init = false;
+    esp_timer_delete(rf_recv->recv_rearm);
+    rf_recv->recv_rearm = NULL;
+
+    recv_release_shared();
+
+    ESP_LOGI(TAG, "RF receiver %d destroyed", rf_recv->id);
+    return ESP_OK;
 }
 
-esp_err_t rf_recv_init(gpio_num_t rx_gpio, RFTransmitter* rf_rmt) {
-    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+/* The hardware filter takes the nanosecond spikes off the pin before they cost an interrupt,
+the software filter in the ISR handles anything longer */
+static void recv_filter_init(RFReceiver* rf_recv) {
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#if SOC_GPIO_FLEX_GLITCH_FILTER_NUM > 0
+    const uint32_t window_ns = rf_recv->recv_min_pulse * 1000 < RF_RECV_FLEX_FILTER_MAX_NS
+        ? rf_recv->recv_min_pulse * 1000 : RF_RECV_FLEX_FILTER_MAX_NS;
+    const gpio_flex_glitch_filter_config_t flex_config = {
+        .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+        .gpio_num = rf_recv->rx_gpio,
+        .window_width_ns = window_ns,
+        .window_thres_ns = window_ns,
+    };
+    err = gpio_new_flex_glitch_filter(&flex_config, &rf_recv->recv_filter);
+#endif
+#if SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+    if (err != ESP_OK) {
+        const gpio_pin_glitch_filter_config_t pin_config = {
+            .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+            .gpio_num = rf_recv->rx_gpio,
+        };
+        err = gpio_new_pin_glitch_filter(&pin_config, &rf_recv->recv_filter);
+    }
+#endif
+    if (err == ESP_OK && gpio_glitch_filter_enable(rf_recv->recv_filter) == ESP_OK) {
+        ESP_LOGI(TAG, "Glitch filter enabled on GPIO %d", rf_recv->rx_gpio);
+        return;
+    }
+    if (rf_recv->recv_filter) gpio_del_glitch_filter(rf_recv->recv_filter);
+    rf_recv->recv_filter = NULL;
+    ESP_LOGI(TAG, "No hardware glitch filter on GPIO %d, filtering in software only", rf_recv->rx_gpio);
+}
+
+esp_err_t rf_recv_init(gpio_num_t rx_gpio, RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is already active");
+
+    recv_protocols_build(rf_recv);
+    recv_frontend_reset(rf_recv);
+    rf_recv->last_time = 0;
+    rf_recv->recv_muted = false;
 
-    rf_rmt->rx_gpio = rx_gpio;
+    rf_recv->rx_gpio = rx_gpio;
+    if (rf_recv->recv_backend == RF_RX_BACKEND_RMT) {
+        const esp_err_t err = rf_rmt_rx_init(rf_recv);
+        if (err != ESP_OK) rf_recv->rx_gpio = GPIO_NUM_NC;
+        return err;
+    }
     ESP_LOGI(TAG, "GPIO %d configured for RF reception", rx_gpio);
 
     gpio_config_t io_conf_rx = {
@@ -93,120 +424,244 @@ esp_err_t rf_recv_init(gpio_num_t rx_gpio, RFTransmitter* rf_rmt) {
         .intr_type = GPIO_INTR_ANYEDGE,
     };
     ESP_ERROR_CHECK(gpio_config(&io_conf_rx));
-    ESP_LOGI(TAG, "ISR service installed");
-    ESP_ERROR_CHECK(gpio_isr_handler_add(rx_gpio, rf_recv_isr_handler, rf_rmt));
+    rf_recv->recv_level = gpio_get_level(rx_gpio);
+    if (rf_recv->recv_min_pulse) recv_filter_init(rf_recv);
+    ESP_ERROR_CHECK(gpio_isr_handler_add(rx_gpio, rf_recv_isr_handler, rf_recv));
     ESP_LOGI(TAG, "ISR handler added for GPIO %d", rx_gpio);
 
-    rf_rmt->recv_value = 0;
-    rf_rmt->recv_bit_length = 0;
-    rf_rmt->recv_delay = 0;
-    rf_rmt->recv_proto = 0;
-    rf_rmt->separation_limit = SEPARATION_LIMIT;
-    rf_rmt->recv_tolerance = RECV_TOLERANCE;
+    ESP_LOGI(TAG, "RF receiver %d initialized", rf_recv->id);
+    return ESP_OK;
+
+}
+
+esp_err_t rf_recv_deinit(RFReceiver* rf_recv, bool restore) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio != GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is not active");
+
+    if (rf_recv->recv_backend == RF_RX_BACKEND_RMT) {
+        ESP_ERROR_CHECK(rf_rmt_rx_deinit(rf_recv));
+    } else {
+        esp_timer_stop(rf_recv->recv_rearm);
+        ESP_ERROR_CHECK(gpio_isr_handler_remove(rf_recv->rx_gpio));
+        ESP_LOGI(TAG, "ISR handler removed for GPIO %d", rf_recv->rx_gpio);
+        if (rf_recv->recv_filter) {
+            gpio_glitch_filter_disable(rf_recv->recv_filter);
+            gpio_del_glitch_filter(rf_recv->recv_filter);
+            rf_recv->recv_filter = NULL;
+        }
+    }
+    ESP_ERROR_CHECK(gpio_reset_pin(rf_recv->rx_gpio));
+    rf_recv->rx_gpio_state = restore ? rf_recv->rx_gpio : GPIO_NUM_NC;
+    rf_recv->rx_gpio = GPIO_NUM_NC;
+
+    ESP_LOGI(TAG, "RF receiver %d deinitialized", rf_recv->id);
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "RF receiver initialized");
+esp_err_t rf_recv_set_decoder(UBaseType_t priority, BaseType_t core) {
+    ESP_RETURN_ON_FALSE(!rf_decode_handle, ESP_ERR_INVALID_STATE, TAG, "Decoder task already running");
+
+    decoder_prio = priority;
+    decoder_core = core;
     return ESP_OK;
+}
+
+esp_err_t rf_recv_set_mode(RFReceiver* rf_recv, RFDecodeMode mode, uint8_t confirm) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
+
+    rf_recv->recv_mode = mode;
+    rf_recv->recv_confirm = confirm;
+    return ESP_OK;
+}
 
+esp_err_t rf_recv_set_backend(RFReceiver* rf_recv, RFRxBackend backend) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
+
+    // Hardware timestamps carry no interrupt latency, so the timing tolerance can be tightened
+    rf_recv->recv_backend = backend;
+    rf_recv->recv_tolerance = backend == RF_RX_BACKEND_RMT ? RF_RMT_RX_TOLERANCE : RECV_TOLERANCE;
+    return ESP_OK;
 }
 
-esp_err_t rf_recv_deinit(RFTransmitter* rf_rmt, bool restore) {
-    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
-    ESP_RETURN_ON_FALSE(rf_rmt->rx_gpio != GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is not active");
+esp_err_t rf_recv_set_frontend(RFReceiver* rf_recv, uint32_t min_pulse_us, uint32_t max_edge_rate, uint32_t mute_us) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
+    ESP_RETURN_ON_FALSE(!max_edge_rate || mute_us, ESP_ERR_INVALID_ARG, TAG, "Rate limiting needs a mute time");
+
+    rf_recv->recv_min_pulse = min_pulse_us;
+    rf_recv->recv_max_edges = (uint64_t)max_edge_rate * RF_RECV_RATE_WINDOW / 1000000;
+    rf_recv->recv_mute_us = mute_us;
+    return ESP_OK;
+}
 
-    ESP_ERROR_CHECK(gpio_isr_handler_remove(rf_rmt->rx_gpio));
-    ESP_LOGI(TAG, "ISR handler removed for GPIO %d", rf_rmt->rx_gpio);
-    ESP_ERROR_CHECK(gpio_reset_pin(rf_rmt->rx_gpio));
-    rf_rmt->rx_gpio = GPIO_NUM_NC;
-    if (!restore) rf_rmt->rx_gpio_state = GPIO_NUM_NC;
+esp_err_t rf_recv_set_calibration(RFReceiver* rf_recv, bool enable) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
+    ESP_RETURN_ON_FALSE(!enable || rf_recv->recv_mode == RF_DECODE_BATCH, ESP_ERR_NOT_SUPPORTED, TAG, "Calibration needs batch decoding");
 
-    ESP_LOGI(TAG, "RF receiver deinitialized");
+    // The decoder task owns the profiles, they are only touched here while the receiver is stopped
+    rf_calib_reset(&rf_recv->recv_calib, RF_CALIB_MIN_TOLERANCE);
+    rf_recv->recv_calibrate = enable;
     return ESP_OK;
 }
 
-esp_err_t recv_available(RFTransmitter* rf_rmt) {
-    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF module");
+esp_err_t rf_recv_set_protocols(RFReceiver* rf_recv, uint32_t enabled) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
 
-    if (rf_rmt->rx_gpio == GPIO_NUM_NC)
-        return ESP_ERR_INVALID_STATE;
+    rf_recv->recv_protocols = enabled;
+    return ESP_OK;
+}
+
+esp_err_t rf_recv_set_registry(RFReceiver* rf_recv, RFRegistry* registry) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
 
-    return (rf_rmt->recv_value != 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+    rf_recv->recv_registry = registry;
+    return ESP_OK;
+}
+
+esp_err_t rf_recv_register(RFRegistry* registry, uint8_t proto_idx, const RFCode* code, uint8_t bit_length, uint32_t handle) {
+    ESP_RETURN_ON_FALSE(registry && code, ESP_ERR_INVALID_ARG, TAG, "Invalid RF registry");
+    ESP_RETURN_ON_FALSE(proto_idx < rf_proto_count() && bit_length <= RF_MAX_CODE_BITS, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+
+    portENTER_CRITICAL(&registry_lock);
+    const bool added = rf_registry_add(registry, proto_idx, code, bit_length, handle);
+    portEXIT_CRITICAL(&registry_lock);
+    ESP_RETURN_ON_FALSE(added, ESP_ERR_NO_MEM, TAG, "RF registry is full");
+    return ESP_OK;
 }
 
-void reset_recv(RFTransmitter* rf_rmt) {
-    ESP_RETURN_VOID_ON_FALSE(rf_rmt && rf_rmt->init, TAG, "Invalid RF module");
-    ESP_RETURN_VOID_ON_FALSE(rf_rmt->rx_gpio != GPIO_NUM_NC, TAG, "RF receiver is not active");
+esp_err_t rf_recv_unregister(RFRegistry* registry, uint8_t proto_idx, const RFCode* code, uint8_t bit_length) {
+    ESP_RETURN_ON_FALSE(registry && code, ESP_ERR_INVALID_ARG, TAG, "Invalid RF registry");
 
-    rf_rmt->recv_value = 0;
+    portENTER_CRITICAL(&registry_lock);
+    const bool removed = rf_registry_remove(registry, proto_idx, code, bit_length);
+    portEXIT_CRITICAL(&registry_lock);
+    return removed ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t rf_recv_set_sniffer(RFReceiver* rf_recv, uint8_t* buf, uint32_t size) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_gpio == GPIO_NUM_NC, ESP_ERR_INVALID_STATE, TAG, "RF receiver is active");
+    ESP_RETURN_ON_FALSE(!buf || (size >= RF_TRACE_MAX_RECORD && !(size & (size - 1))), ESP_ERR_INVALID_SIZE, TAG, "Sniffer buffer size must be a power of two");
+
+    rf_trace_ring_init(&rf_recv->recv_sniff, buf, buf ? size : 0);
+    return ESP_OK;
 }
 
-static void decode_recv(RFTransmitter* rf_rmt, RFRecvData* recv_data) {
-    ESP_RETURN_VOID_ON_FALSE(rf_rmt && rf_rmt->init, TAG, "Invalid RF module");
-    ESP_RETURN_VOID_ON_FALSE(rf_rmt->rx_gpio != GPIO_NUM_NC, TAG, "RF receiver is not active");
+size_t rf_recv_sniffer_read(RFReceiver* rf_recv, uint8_t* out, size_t max) {
+    if (!rf_recv || !rf_recv->recv_sniff.buf || !out) return 0;
+    return rf_trace_ring_read(&rf_recv->recv_sniff, out, max);
+}
 
-    uint32_t code = rf_rmt->recv_value;
-    const uint32_t recv_len = rf_rmt->recv_bit_length;
-    recv_data->original_value = code;
-    recv_data->tri_state = NULL;
-    recv_data->binary = NULL;
+esp_err_t rf_recv_sniffer_to_partition(RFReceiver* rf_recv, const esp_partition_t* partition, size_t* offset) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->recv_sniff.buf && partition && offset, ESP_ERR_INVALID_ARG, TAG, "Invalid RF sniffer");
 
-    static char buffer[64];
-    uint8_t pos = 0;
-    while (code) {
-        buffer[32 + pos] = (code & 1) ? '1' : '0';
-        code >>= 1;
-        pos++;
+    if (*offset == 0) {
+        ESP_RETURN_ON_ERROR(esp_partition_erase_range(partition, 0, partition->size), TAG, "Failed to erase trace partition");
+        ESP_RETURN_ON_ERROR(esp_partition_write(partition, 0, RF_TRACE_MAGIC, RF_TRACE_HEADER), TAG, "Failed to write trace header");
+        *offset = RF_TRACE_HEADER;
     }
 
-    for (uint8_t j = 0; j < recv_len; j++) {
-        if (j >= recv_len - pos) buffer[j] = buffer[31 - j + recv_len];
-        else buffer[j] = '0';
+    uint8_t chunk[256];
+    while (*offset < partition->size) {
+        const size_t room = partition->size - *offset;
+        const size_t len = rf_trace_ring_read(&rf_recv->recv_sniff, chunk, room < sizeof(chunk) ? room : sizeof(chunk));
+        if (!len) return ESP_OK;
+        ESP_RETURN_ON_ERROR(esp_partition_write(partition, *offset, chunk, len), TAG, "Failed to write trace");
+        *offset += len;
     }
-    buffer[recv_len] = '\0';
-    recv_data->binary = malloc(recv_len + 1);
-    if (recv_data->binary) {
-        strcpy(recv_data->binary, buffer);
-    } else {
-        ESP_LOGE(TAG, "Memory allocation failed for binary data");
-        return;
+    return ESP_ERR_INVALID_SIZE;
+}
+
+esp_err_t recv_available(RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+
+    if (rf_recv->rx_gpio == GPIO_NUM_NC)
+        return ESP_ERR_INVALID_STATE;
+
+    return (rf_ring_count(&rf_recv->recv_ring) > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void reset_recv(RFReceiver* rf_recv) {
+    ESP_RETURN_VOID_ON_FALSE(rf_recv && rf_recv->init, TAG, "Invalid RF receiver");
+    ESP_RETURN_VOID_ON_FALSE(rf_recv->rx_gpio != GPIO_NUM_NC, TAG, "RF receiver is not active");
+
+    rf_ring_flush(&rf_recv->recv_ring);
+}
+
+esp_err_t rf_recv_wait(RFReceiver* rf_recv, RFRecvFrame* frame, TickType_t timeout) {
+    return rf_recv_wait_any(&rf_recv, 1, frame, timeout);
+}
+
+esp_err_t rf_recv_wait_any(RFReceiver* const* receivers, uint8_t count, RFRecvFrame* frame, TickType_t timeout) {
+    ESP_RETURN_ON_FALSE(receivers && count > 0 && frame, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receivers");
+
+    // Only one consumer task per receiver, it becomes the notification target
+    const TaskHandle_t consumer = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_FALSE(receivers[i] && receivers[i]->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+        receivers[i]->rf_recv_handle = consumer;
     }
 
-    pos = 0;
-    uint8_t pos2 = 0;
-    memset(buffer, 0, sizeof(buffer));
-    const char* ref = recv_data->binary;
-    while (ref[pos] && ref[pos + 1]) {
-        if (ref[pos] == '0' && ref[pos + 1] == '0') 
-            buffer[pos2] = '0';
-        else if (ref[pos] == '1' && ref[pos + 1] == '1')
-            buffer[pos2] = '1';
-        else if (ref[pos] == '0' && ref[pos + 1] == '1')
-            buffer[pos2] = 'F';
-        else {
-            ESP_LOGE(TAG, "Invalid data: %c%c", ref[pos], ref[pos + 1]);
-            return;
+    TimeOut_t time_out;
+    vTaskSetTimeOutState(&time_out);
+    while (1) {
+        // Deliver in capture order across receivers
+        RFRecvRing* oldest = NULL;
+        int64_t oldest_time = INT64_MAX;
+        for (uint8_t i = 0; i < count; i++) {
+            const RFRecvFrame* head = rf_ring_peek(&receivers[i]->recv_ring);
+            if (head && head->timestamp < oldest_time) {
+                oldest_time = head->timestamp;
+                oldest = &receivers[i]->recv_ring;
+            }
         }
-        pos += 2;
-        pos2++;
-    }
-    buffer[pos2] = '\0';
-    recv_data->tri_state = malloc(pos2 + 1);
-    if (recv_data->tri_state) {
-        strcpy(recv_data->tri_state, buffer);
-    } else {
-        ESP_LOGE(TAG, "Memory allocation failed for tri-state data");
-        return;
+        if (oldest && rf_ring_pop(oldest, frame))
+            return ESP_OK;
+
+        if (xTaskCheckForTimeOut(&time_out, &timeout) == pdTRUE)
+            return ESP_ERR_TIMEOUT;
+        ulTaskNotifyTake(pdTRUE, timeout);
     }
+}
+
+esp_err_t rf_recv_get_stats(RFReceiver* rf_recv, RFRecvStats* stats) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
 
-    ESP_LOGI(TAG, "Decode completed");
+    stats->frames = rf_recv->recv_frames;
+    stats->overflows = __atomic_load_n(&rf_recv->recv_ring.overflows, __ATOMIC_RELAXED);
+    stats->pool_overflows = rf_recv->recv_pool_overflows;
+    stats->isr_max_cycles = rf_recv->recv_isr_max_cycles;
+    stats->isr_calls = rf_recv->recv_isr_calls;
+    stats->isr_cycles = rf_recv->recv_isr_cycles;
+    return ESP_OK;
+}
+
+esp_err_t rf_decode_frame(const RFRecvFrame* frame, RFRecvData* recv_data) {
+    ESP_RETURN_ON_FALSE(frame && recv_data, ESP_ERR_INVALID_ARG, TAG, "Invalid RF frame");
+    return rf_decode_code(&frame->code, frame->bit_length, recv_data) ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
 }
 
-void output_recv(RFTransmitter* rf_rmt) {
+void output_recv(const RFRecvFrame* frame) {
     RFRecvData recv_data;
-    decode_recv(rf_rmt, &recv_data);
-    ESP_LOGI(TAG, "Received data!");
-    ESP_LOGI(TAG, "Original value: %lu", recv_data.original_value);
-    ESP_LOGI(TAG, "Hexadecimal: 0x%lx", recv_data.original_value);
+    if (rf_decode_frame(frame, &recv_data) != ESP_OK)
+        ESP_LOGW(TAG, "Code has no tri-state form");
+    ESP_LOGI(TAG, "Received data on receiver %d!", frame->rx_id);
+    if (frame->event == RF_RECV_EVENT_PRESS || frame->event == RF_RECV_EVENT_HELD)
+        ESP_LOGI(TAG, "Code %lu %s", frame->handle, frame->event == RF_RECV_EVENT_PRESS ? "pressed" : "held");
+    if (frame->bit_length <= 64) {
+        ESP_LOGI(TAG, "Original value: %llu", rf_code_u64(&recv_data.code));
+    }
+    char hex[RF_CODE_WORDS * 8 + 1];
+    for (uint8_t i = 0; i < RF_CODE_WORDS; i++)
+        snprintf(&hex[i * 8], 9, "%08lx", recv_data.code.words[RF_CODE_WORDS - 1 - i]);
+    ESP_LOGI(TAG, "Hexadecimal: 0x%s", &hex[(RF_CODE_WORDS - (frame->bit_length + 31) / 32) * 8]);
     ESP_LOGI(TAG, "Binary: %s", recv_data.binary);
     ESP_LOGI(TAG, "Tri-state: %s", recv_data.tri_state);
-    ESP_LOGI(TAG, "Pulse length: %lu", rf_rmt->recv_delay);
+    ESP_LOGI(TAG, "Pulse length: %lu", frame->delay);
+    ESP_LOGI(TAG, "Protocol: %d (quality %d%%, %d candidates)", frame->proto + 1, frame->quality, frame->candidates);
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <string.h>
+#include "rf_core.h"
+
+static uint32_t RF_IRAM_ATTR registry_hash(uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    uint32_t h = proto | (uint32_t)bit_length << 8;
+    for (uint8_t i = 0; i < RF_CODE_WORDS; i++) {
+        h = (h ^ code->words[i]) * 0x9E3779B1;
+        h ^= h >> 15;
+    }
+    return h;
+}
+
+static inline bool RF_IRAM_ATTR entry_matches(const RFRegistryEntry* e, uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    return e->proto == proto && e->bit_length == bit_length && rf_code_equal(&e->code, code);
+}
+
+// Slot holding the code, or NULL. Probing stops at the first never used slot
+static RFRegistryEntry* RF_IRAM_ATTR registry_lookup(const RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    uint32_t slot = registry_hash(proto, code, bit_length);
+    for (uint32_t i = 0; i < RF_REGISTRY_SIZE; i++, slot++) {
+        const RFRegistryEntry* e = &reg->entries[slot & (RF_REGISTRY_SIZE - 1)];
+        if (e->state == RF_REGISTRY_EMPTY) return NULL;
+        if (e->state == RF_REGISTRY_USED && entry_matches(e, proto, code, bit_length)) return (RFRegistryEntry*)e;
+    }
+    return NULL;
+}
+
+void rf_registry_init(RFRegistry* reg, uint32_t holdoff, uint32_t held_after, bool drop_unknown) {
+    memset(reg, 0, sizeof(RFRegistry));
+    reg->holdoff = holdoff;
+    reg->held_after = held_after;
+    reg->drop_unknown = drop_unknown;
+}
+
+bool rf_registry_add(RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length, uint32_t handle) {
+    RFRegistryEntry* e = registry_lookup(reg, proto, code, bit_length);
+    if (e) {
+        e->handle = handle;
+        return true;
+    }
+    // Keep one slot empty so lookups of missing codes always terminate early
+    if (reg->count >= RF_REGISTRY_SIZE - 1) return false;
+
+    uint32_t slot = registry_hash(proto, code, bit_length);
+    for (;; slot++) {
+        e = &reg->entries[slot & (RF_REGISTRY_SIZE - 1)];
+        if (e->state != RF_REGISTRY_USED) break;
+    }
+    memset(e, 0, sizeof(RFRegistryEntry));
+    e->code = *code;
+    e->handle = handle;
+    e->proto = proto;
+    e->bit_length = bit_length;
+    e->state = RF_REGISTRY_USED;
+    reg->count++;
+    return true;
+}
+
+bool rf_registry_remove(RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    RFRegistryEntry* e = registry_lookup(reg, proto, code, bit_length);
+    if (!e) return false;
+    e->state = RF_REGISTRY_DELETED;
+    reg->count--;
+    return true;
+}
+
+const RFRegistryEntry* rf_registry_find(const RFRegistry* reg, uint8_t proto, const RFCode* code, uint8_t bit_length) {
+    return registry_lookup(reg, proto, code, bit_length);
+}
+
+bool RF_IRAM_ATTR rf_registry_feed(RFRegistry* reg, RFRecvFrame* frame) {
+    RFRegistryEntry* e = registry_lookup(reg, frame->proto, &frame->code, frame->bit_length);
+    const int64_t now = frame->timestamp;
+    frame->handle = 0;
+
+    if (!e) {
+        if (reg->drop_unknown) return false;
+        e = &reg->unknown;
+        if (e->state != RF_REGISTRY_USED || !entry_matches(e, frame->proto, &frame->code, frame->bit_length)) {
+            e->code = frame->code;
+            e->proto = frame->proto;
+            e->bit_length = frame->bit_length;
+            e->state = RF_REGISTRY_USED;
+            e->last_seen = 0;
+        }
+    }
+
+    // Still the same press while the repeats keep coming within the hold-off
+    const bool repeat = e->last_seen && now - e->last_seen < reg->holdoff;
+    e->last_seen = now;
+    if (!repeat) {
+        e->first_seen = now;
+        e->held = false;
+        frame->event = e == &reg->unknown ? RF_RECV_EVENT_UNKNOWN : RF_RECV_EVENT_PRESS;
+        frame->handle = e->handle;
+        return true;
+    }
+    if (e == &reg->unknown || e->held || !reg->held_after || now - e->first_seen < reg->held_after) return false;
+
+    e->held = true;
+    frame->event = RF_RECV_EVENT_HELD;
+    frame->handle = e->handle;
+    return true;
+}
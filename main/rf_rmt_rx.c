@@ -0,0 +1,245 @@
+#include <string.h>
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
+
+// Partial receive hands a long capture over piece by piece, so a line that never goes idle is still decoded
+#if SOC_RMT_SUPPORT_RX_PINGPONG && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#define RF_RMT_RX_PARTIAL 1
+#else
+#define RF_RMT_RX_PARTIAL 0
+#endif
+
+enum {
+    RF_RMT_RX_CHUNK_END = 1 << 0,          // The line went idle after the chunk
+    RF_RMT_RX_CHUNK_CONT = 1 << 1,         // Carries on from the previous chunk without a break
+    RF_RMT_RX_CHUNK_AFTER_IDLE = 1 << 2,   // The previous chunk ended on idle and nothing was dropped since
+};
+
+static void IRAM_ATTR rmt_rx_arm(RFReceiver* rf_recv) {
+    rmt_receive(rf_recv->rx_chan, rf_recv->rmt_rx_dma, RF_RMT_RX_BUFFER_SYMBOLS * sizeof(rmt_symbol_word_t),
+        &rf_recv->rmt_rx_config);
+}
+
+static bool IRAM_ATTR rf_rmt_rx_done_callback(rmt_channel_handle_t chan, const rmt_rx_done_event_data_t *edata, void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    RFReceiver* rf_recv = (RFReceiver*)arg;
+#if RF_RMT_RX_PARTIAL
+    const bool end = edata->flags.is_last;
+#else
+    // Without partial receive a full buffer cuts the capture short, the line did not go idle
+    const bool end = edata->num_symbols < RF_RMT_RX_BUFFER_SYMBOLS;
+#endif
+    const uint8_t flags = (end ? RF_RMT_RX_CHUNK_END : 0) | (rf_recv->rmt_rx_cont ? RF_RMT_RX_CHUNK_CONT : 0) |
+        (rf_recv->rmt_rx_after_idle ? RF_RMT_RX_CHUNK_AFTER_IDLE : 0);
+    rf_recv->rmt_rx_cont = false;
+    rf_recv->rmt_rx_after_idle = false;
+
+    const uint32_t busy = __atomic_load_n(&rf_recv->rmt_rx_busy, __ATOMIC_ACQUIRE);
+    const uint8_t idx = (busy & 1) ? 1 : 0;
+    if (rf_recv->recv_muted) {
+        // Noise storm, dropped without waking the decoder
+    } else if (busy & (1UL << idx)) {
+        rf_metrics_inc(RF_METRIC_POOL_OVERFLOWS);
+    } else {
+        memcpy(rf_recv->rmt_rx_buf[idx], edata->received_symbols, edata->num_symbols * sizeof(rmt_symbol_word_t));
+        rf_recv->rmt_rx_count[idx] = edata->num_symbols;
+        rf_recv->rmt_rx_end[idx] = esp_timer_get_time();
+        rf_recv->rmt_rx_flags[idx] = flags;
+        __atomic_fetch_or(&rf_recv->rmt_rx_busy, 1UL << idx, __ATOMIC_RELEASE);
+        if (rf_recv_post_from_isr(rf_recv, RF_DECODE_JOB_RMT, idx, &xHigherPriorityTaskWoken)) {
+            rf_recv->rmt_rx_cont = RF_RMT_RX_PARTIAL && !end;
+            rf_recv->rmt_rx_after_idle = end;
+        } else {
+            __atomic_fetch_and(&rf_recv->rmt_rx_busy, ~(1UL << idx), __ATOMIC_RELEASE);
+            rf_metrics_inc(RF_METRIC_POOL_OVERFLOWS);
+        }
+    }
+
+    // The chunk was copied out, so the next capture can start in the same buffer right away
+    if (edata->flags.is_last) rmt_rx_arm(rf_recv);
+
+    return (xHigherPriorityTaskWoken == pdTRUE);
+}
+
+// Noise storm: drop captured chunks until the re-arm timer fires, the hardware keeps capturing on its own
+static void rmt_rx_mute(RFReceiver* rf_recv) {
+    rf_recv->rmt_rx_skip = true;
+    rf_recv->recv_muted = true;
+    esp_timer_start_once(rf_recv->recv_rearm, rf_recv->recv_mute_us);
+    rf_metrics_inc(RF_METRIC_MUTES);
+}
+
+static uint32_t first_gap(const rmt_symbol_word_t* symbols, size_t count, uint32_t separation_limit) {
+    for (size_t i = 0; i < count; i++) {
+        if (symbols[i].duration0 > separation_limit) return symbols[i].duration0;
+        if (symbols[i].duration1 > separation_limit) return symbols[i].duration1;
+    }
+    return 0;
+}
+
+void rf_rmt_rx_process(RFReceiver* rf_recv, uint8_t idx) {
+    const rmt_symbol_word_t* symbols = rf_recv->rmt_rx_buf[idx];
+    const size_t count = rf_recv->rmt_rx_count[idx];
+    const uint8_t flags = rf_recv->rmt_rx_flags[idx];
+
+    if (!(flags & RF_RMT_RX_CHUNK_CONT)) {
+        // A capture ends one idle threshold after its last edge
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++)
+            total += symbols[i].duration0 + symbols[i].duration1;
+        const int64_t start = rf_recv->rmt_rx_end[idx] - ((flags & RF_RMT_RX_CHUNK_END) ? rf_recv->rmt_rx_idle_us : 0) - (int64_t)total;
+        const int64_t idle = start - rf_recv->rmt_rx_time;
+
+        rf_recv->rmt_rx_skip = false;
+        if ((flags & RF_RMT_RX_CHUNK_AFTER_IDLE) && idle > 0 && idle < RF_RMT_RX_IDLE_US) {
+            // A gap just over the idle threshold split the burst, frame across the two captures
+            rf_recv->rmt_rx_last_gap = (uint32_t)idle;
+            rf_recv_feed_edge(rf_recv, (uint32_t)idle, start);
+        } else {
+            // Nothing spans a long idle or a dropped chunk
+            rf_framer_reset(&rf_recv->recv_framer, rf_recv->separation_limit);
+            rf_glitch_reset(&rf_recv->recv_glitch, rf_recv->recv_min_pulse);
+            if (rf_recv->recv_mode == RF_DECODE_STREAM) rf_stream_reset(&rf_recv->recv_stream);
+            rf_recv->rmt_rx_last_gap = 0;
+
+            // The first frame of a burst has no gap in front of it, the burst's own sync stands in
+            const uint32_t lead = first_gap(symbols, count, rf_recv->separation_limit);
+            if (lead) rf_recv_feed_edge(rf_recv, lead, start);
+        }
+        rf_recv->rmt_rx_time = start;
+    }
+
+    int64_t time = rf_recv->rmt_rx_time;
+    for (size_t i = 0; i < count && !rf_recv->rmt_rx_skip; i++) {
+        const uint32_t halves[2] = { symbols[i].duration0, symbols[i].duration1 };
+        for (uint8_t h = 0; h < 2; h++) {
+            // A zero duration marks the end of the capture
+            if (!halves[h]) continue;
+            time += halves[h];
+            if (rf_rate_limit_feed(&rf_recv->recv_limit, time)) {
+                rmt_rx_mute(rf_recv);
+                break;
+            }
+            if (halves[h] > rf_recv->separation_limit) rf_recv->rmt_rx_last_gap = halves[h];
+            if (rf_recv->recv_sniff.buf)
+                rf_trace_ring_push(&rf_recv->recv_sniff, h ? symbols[i].level1 : symbols[i].level0, halves[h]);
+            rf_recv_feed_edge(rf_recv, halves[h], time);
+        }
+    }
+    rf_recv->rmt_rx_time = time;
+
+    if ((flags & RF_RMT_RX_CHUNK_END) && !rf_recv->rmt_rx_skip) {
+        if (rf_recv->recv_sniff.buf) rf_trace_ring_push(&rf_recv->recv_sniff, 0, rf_recv->rmt_rx_idle_us);
+        // The idle that ended the capture hides the closing gap of the last frame, stand in the last gap seen
+        const uint32_t last_gap = rf_recv->rmt_rx_last_gap;
+        if (last_gap) rf_recv_feed_edge(rf_recv, last_gap, time + last_gap);
+    }
+
+    __atomic_fetch_and(&rf_recv->rmt_rx_busy, ~(1UL << idx), __ATOMIC_RELEASE);
+}
+
+// Just over the longest sync gap of the enabled protocols, so a capture ends soon after a burst
+static uint32_t rmt_rx_idle_us(const RFReceiver* rf_recv) {
+    uint32_t idle = rf_recv->separation_limit;
+    for (uint8_t i = 0; i < rf_proto_count(); i++) {
+        if (!(rf_recv->recv_protocols & (1UL << i))) continue;
+        const Protocol* proto = rf_proto_get(i);
+        const uint32_t sync = proto->pulse_length *
+            (proto->sync_factor.high > proto->sync_factor.low ? proto->sync_factor.high : proto->sync_factor.low);
+        if (sync > idle) idle = sync;
+    }
+    idle += RF_FRAMER_GAP_MATCH;
+    return idle < RF_RMT_RX_IDLE_US ? idle : RF_RMT_RX_IDLE_US;
+}
+
+static void rmt_rx_free(RFReceiver* rf_recv) {
+    heap_caps_free(rf_recv->rmt_rx_dma);
+    rf_recv->rmt_rx_dma = NULL;
+    for (uint8_t i = 0; i < 2; i++) {
+        heap_caps_free(rf_recv->rmt_rx_buf[i]);
+        rf_recv->rmt_rx_buf[i] = NULL;
+    }
+}
+
+esp_err_t rf_rmt_rx_init(RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(!rf_recv->rx_chan, ESP_ERR_INVALID_STATE, TAG, "RMT capture already active");
+    esp_err_t ret = ESP_OK;
+
+    rf_recv->rmt_rx_dma = heap_caps_calloc(RF_RMT_RX_BUFFER_SYMBOLS, sizeof(rmt_symbol_word_t),
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    for (uint8_t i = 0; i < 2; i++)
+        rf_recv->rmt_rx_buf[i] = heap_caps_calloc(RF_RMT_RX_BUFFER_SYMBOLS, sizeof(rmt_symbol_word_t), MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(rf_recv->rmt_rx_dma && rf_recv->rmt_rx_buf[0] && rf_recv->rmt_rx_buf[1], ESP_ERR_NO_MEM, err,
+        TAG, "Failed to allocate RMT capture buffers");
+
+    rmt_rx_channel_config_t rx_chan_config = {
+        .gpio_num = rf_recv->rx_gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DEFAULT_RESOLUTION,
+        .mem_block_symbols = RF_RMT_RX_MEM_SYMBOLS,
+#if SOC_RMT_SUPPORT_DMA
+        .flags.with_dma = true,
+#endif
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_rx_channel(&rx_chan_config, &rf_recv->rx_chan), err, TAG, "Failed to create RMT RX channel");
+    ESP_LOGI(TAG, "RMT RX channel created on GPIO %d", rf_recv->rx_gpio);
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = rf_rmt_rx_done_callback,
+    };
+    ESP_GOTO_ON_ERROR(rmt_rx_register_event_callbacks(rf_recv->rx_chan, &cbs, rf_recv), err, TAG, "Failed to register RMT RX callbacks");
+    ESP_GOTO_ON_ERROR(rmt_enable(rf_recv->rx_chan), err, TAG, "Failed to enable RMT RX channel");
+
+    rf_recv->rmt_rx_idle_us = rmt_rx_idle_us(rf_recv);
+    rf_recv->rmt_rx_config = (rmt_receive_config_t) {
+        .signal_range_min_ns = RF_RMT_RX_MIN_NS,
+        .signal_range_max_ns = rf_recv->rmt_rx_idle_us * 1000,
+#if RF_RMT_RX_PARTIAL
+        .flags.en_partial_rx = true,
+#endif
+    };
+    rf_recv->rmt_rx_busy = 0;
+    rf_recv->rmt_rx_cont = false;
+    rf_recv->rmt_rx_after_idle = false;
+    rf_recv->rmt_rx_skip = false;
+    rf_recv->rmt_rx_time = 0;
+    ESP_GOTO_ON_ERROR(rmt_receive(rf_recv->rx_chan, rf_recv->rmt_rx_dma, RF_RMT_RX_BUFFER_SYMBOLS * sizeof(rmt_symbol_word_t),
+        &rf_recv->rmt_rx_config), err_enabled, TAG, "Failed to start RMT capture");
+
+    ESP_LOGI(TAG, "RF receiver %d capturing with RMT, idle after %lu us", rf_recv->id, rf_recv->rmt_rx_idle_us);
+    return ESP_OK;
+
+err_enabled:
+    rmt_disable(rf_recv->rx_chan);
+err:
+    if (rf_recv->rx_chan) rmt_del_channel(rf_recv->rx_chan);
+    rf_recv->rx_chan = NULL;
+    rmt_rx_free(rf_recv);
+    return ret;
+}
+
+esp_err_t rf_rmt_rx_deinit(RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_recv && rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+    ESP_RETURN_ON_FALSE(rf_recv->rx_chan, ESP_ERR_INVALID_STATE, TAG, "RMT capture is not active");
+
+    rmt_channel_handle_t chan = rf_recv->rx_chan;
+    esp_timer_stop(rf_recv->recv_rearm);
+    ESP_ERROR_CHECK(rmt_disable(chan));
+    rf_recv->rx_chan = NULL;
+    rf_recv->recv_muted = false;
+
+    // Let the decoder finish the chunks it holds before the buffers go away
+    while (__atomic_load_n(&rf_recv->rmt_rx_busy, __ATOMIC_ACQUIRE))
+        vTaskDelay(1);
+    ESP_ERROR_CHECK(rmt_del_channel(chan));
+    rmt_rx_free(rf_recv);
+
+    ESP_LOGI(TAG, "RMT capture stopped on GPIO %d", rf_recv->rx_gpio);
+    return ESP_OK;
+}
@@ -0,0 +1,115 @@
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static bool IRAM_ATTR rf_rmt_tx_done_callback(rmt_channel_handle_t chan, const rmt_tx_done_event_data_t *edata, void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    RFTransmitter* rf_rmt = (RFTransmitter*)arg;
+
+    if (rf_rmt->rmt_pending && --rf_rmt->rmt_pending == 0) {
+        rf_rmt->tx_active = false;
+        rf_rmt->current_rep = 0;
+        if (rf_rmt->tx_duplex && rf_rmt->rx) rf_recv_echo_end(rf_rmt->rx);
+        rf_metrics_record(RF_HIST_TX_SEND_US, (uint32_t)(esp_timer_get_time() - rf_rmt->tx_start));
+        if (rf_rmt->rf_trans_handle)
+            vTaskNotifyGiveFromISR(rf_rmt->rf_trans_handle, &xHigherPriorityTaskWoken);
+    }
+
+    return (xHigherPriorityTaskWoken == pdTRUE);
+}
+
+esp_err_t rf_rmt_tx_init(RFTransmitter* rf_rmt) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(rf_rmt->tx_backend == RF_TX_BACKEND_GPTIMER, ESP_ERR_INVALID_STATE, TAG, "RMT engine already active");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+
+    ESP_ERROR_CHECK(rf_timer_deinit(rf_rmt->timer));
+    rf_rmt->timer = NULL;
+
+    rmt_tx_channel_config_t tx_chan_config = {
+        .gpio_num = rf_rmt->tx_gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DEFAULT_RESOLUTION,
+        .mem_block_symbols = RF_RMT_TX_MEM_SYMBOLS,
+        .trans_queue_depth = RF_RMT_TX_QUEUE_DEPTH,
+    };
+    ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &rf_rmt->tx_chan));
+    ESP_LOGI(TAG, "RMT TX channel created on GPIO %d", rf_rmt->tx_gpio);
+
+    rmt_copy_encoder_config_t encoder_config = {};
+    ESP_ERROR_CHECK(rmt_new_copy_encoder(&encoder_config, &rf_rmt->tx_encoder));
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = rf_rmt_tx_done_callback,
+    };
+    ESP_ERROR_CHECK(rmt_tx_register_event_callbacks(rf_rmt->tx_chan, &cbs, rf_rmt));
+    ESP_ERROR_CHECK(rmt_enable(rf_rmt->tx_chan));
+
+    rf_rmt->rmt_pending = 0;
+    rf_rmt->tx_backend = RF_TX_BACKEND_RMT;
+    ESP_LOGI(TAG, "RMT transmission engine enabled");
+    return ESP_OK;
+}
+
+esp_err_t rf_rmt_tx_deinit(RFTransmitter* rf_rmt) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(rf_rmt->tx_backend == RF_TX_BACKEND_RMT, ESP_ERR_INVALID_STATE, TAG, "RMT engine is not active");
+
+    ESP_ERROR_CHECK(rmt_disable(rf_rmt->tx_chan));
+    ESP_ERROR_CHECK(rmt_del_encoder(rf_rmt->tx_encoder));
+    ESP_ERROR_CHECK(rmt_del_channel(rf_rmt->tx_chan));
+    rf_rmt->tx_encoder = NULL;
+    rf_rmt->tx_chan = NULL;
+
+    rf_rmt->rmt_pending = 0;
+    rf_rmt->tx_active = false;
+
+    // The RMT channel took over the pin, hand it back to the GPIO + timer engine
+    gpio_config_t io_conf_tx = {
+        .pin_bit_mask = (1ULL << rf_rmt->tx_gpio),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf_tx));
+    ESP_ERROR_CHECK(gpio_set_level(rf_rmt->tx_gpio, 0));
+
+    rf_rmt->tx_backend = RF_TX_BACKEND_GPTIMER;
+    ESP_ERROR_CHECK(rf_timer_init(rf_rmt));
+    ESP_LOGI(TAG, "RMT transmission engine disabled");
+    return ESP_OK;
+}
+
+esp_err_t rf_rmt_tx_send(RFTransmitter* rf_rmt) {
+    // Packed pulses are RMT half symbols, so the pulse buffer is transmitted as-is
+    ESP_RETURN_ON_FALSE(rf_rmt->pulse_count % 2 == 0, ESP_ERR_INVALID_SIZE, TAG, "RF data must hold whole RMT symbols");
+    const size_t symbol_count = rf_rmt->pulse_count / 2;
+
+    // Hardware loop needs the whole train (plus end marker) resident in channel memory
+    const bool hw_loop = symbol_count < RF_RMT_TX_MEM_SYMBOLS;
+    rmt_transmit_config_t tx_config = {
+        .loop_count = hw_loop ? rf_rmt->tx_repeats : 0,
+        .flags.eot_level = 0,
+    };
+
+    rf_rmt->tx_active = true;
+    rf_rmt->current_rep = 0;
+    rf_rmt->rmt_pending = hw_loop ? 1 : rf_rmt->tx_repeats;
+
+    const uint8_t transactions = rf_rmt->rmt_pending;
+    for (uint8_t i = 0; i < transactions; i++) {
+        esp_err_t err = rmt_transmit(rf_rmt->tx_chan, rf_rmt->tx_encoder, rf_rmt->pulses,
+            rf_rmt->pulse_count * sizeof(RFPulse), &tx_config);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "RMT transmission failed: %s", esp_err_to_name(err));
+            rf_rmt->rmt_pending -= transactions - i;
+            if (i == 0) rf_rmt->tx_active = false;
+            return err;
+        }
+    }
+
+    return ESP_OK;
+}
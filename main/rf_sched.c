@@ -0,0 +1,92 @@
+#include <string.h>
+#include "rf_core.h"
+
+static inline bool earlier(const RFSched* sched, uint8_t a, uint8_t b) {
+    return sched->channels[sched->heap[a]].next < sched->channels[sched->heap[b]].next;
+}
+
+static inline void heap_swap(RFSched* sched, uint8_t a, uint8_t b) {
+    const uint8_t t = sched->heap[a];
+    sched->heap[a] = sched->heap[b];
+    sched->heap[b] = t;
+}
+
+static void sift_up(RFSched* sched, uint8_t i) {
+    while (i > 0 && earlier(sched, i, (i - 1) / 2)) {
+        heap_swap(sched, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void RF_IRAM_ATTR sift_down(RFSched* sched, uint8_t i) {
+    while (1) {
+        const uint8_t left = 2 * i + 1, right = left + 1;
+        uint8_t best = i;
+        if (left < sched->heap_count && earlier(sched, left, best)) best = left;
+        if (right < sched->heap_count && earlier(sched, right, best)) best = right;
+        if (best == i) return;
+        heap_swap(sched, i, best);
+        i = best;
+    }
+}
+
+void rf_sched_init(RFSched* sched, uint32_t merge) {
+    memset(sched, 0, sizeof(RFSched));
+    sched->merge = merge;
+}
+
+bool rf_sched_start(RFSched* sched, uint8_t channel, const RFPulse* pulses, size_t count, uint8_t repeat, uint64_t start) {
+    if (channel >= RF_SCHED_CHANNELS || !pulses || !count || !repeat) return false;
+    RFSchedChannel* ch = &sched->channels[channel];
+    if (ch->active) return false;
+
+    ch->pulses = pulses;
+    ch->count = count;
+    ch->index = SIZE_MAX;
+    ch->next = start;
+    ch->repeat = repeat;
+    ch->rep = 0;
+    ch->active = true;
+    sched->heap[sched->heap_count] = channel;
+    sift_up(sched, sched->heap_count++);
+    return true;
+}
+
+uint64_t RF_IRAM_ATTR rf_sched_step(RFSched* sched, uint32_t* high, uint32_t* low, uint32_t* done) {
+    *high = *low = *done = 0;
+    if (!sched->heap_count) return UINT64_MAX;
+
+    const uint64_t now = sched->channels[sched->heap[0]].next;
+    while (sched->heap_count && sched->channels[sched->heap[0]].next <= now + sched->merge) {
+        const uint8_t channel = sched->heap[0];
+        const uint32_t bit = 1UL << channel;
+        RFSchedChannel* ch = &sched->channels[channel];
+
+        ch->index = ch->index == SIZE_MAX ? 0 : ch->index + 1;
+        if (ch->index == ch->count) {
+            ch->index = 0;
+            if (++ch->rep >= ch->repeat) {
+                // Finished: back to idle low and out of the heap
+                ch->active = false;
+                *high &= ~bit;
+                *low |= bit;
+                *done |= bit;
+                sched->heap[0] = sched->heap[--sched->heap_count];
+                sift_down(sched, 0);
+                continue;
+            }
+        }
+
+        const RFPulse pulse = ch->pulses[ch->index];
+        if (RF_PULSE_LEVEL(pulse)) {
+            *high |= bit;
+            *low &= ~bit;
+        } else {
+            *low |= bit;
+            *high &= ~bit;
+        }
+        ch->next += RF_PULSE_TICKS(pulse);
+        sift_down(sched, 0);
+    }
+    return now;
+}
@@ -0,0 +1,145 @@
+#include <string.h>
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "soc/gpio_reg.h"
+
+// Every pin that changes in a step goes out in one set and one clear register write
+static void IRAM_ATTR sched_apply(const RFTxScheduler* rf_sched, uint32_t high, uint32_t low) {
+    uint64_t set = 0, clear = 0;
+    for (; high; high &= high - 1) set |= rf_sched->channels[__builtin_ctz(high)].pin_mask;
+    for (; low; low &= low - 1) clear |= rf_sched->channels[__builtin_ctz(low)].pin_mask;
+    if ((uint32_t)set) REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)set);
+    if ((uint32_t)clear) REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)clear);
+#if SOC_GPIO_PIN_COUNT > 32
+    if (set >> 32) REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(set >> 32));
+    if (clear >> 32) REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(clear >> 32));
+#endif
+}
+
+static bool IRAM_ATTR sched_timer_callback(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    RFTxScheduler* rf_sched = (RFTxScheduler*)arg;
+    uint32_t done_all = 0;
+
+    portENTER_CRITICAL_ISR(&rf_sched->lock);
+    // Catch up on edges that fell due while this one was being handled
+    uint64_t next;
+    do {
+        uint32_t high, low, done;
+        rf_sched_step(&rf_sched->sched, &high, &low, &done);
+        sched_apply(rf_sched, high, low);
+        done_all |= done;
+        next = rf_sched_next(&rf_sched->sched);
+    } while (next <= edata->count_value);
+
+    if (next != UINT64_MAX) {
+        gptimer_alarm_config_t next_alarm = {
+            .alarm_count = next,
+        };
+        gptimer_set_alarm_action(timer, &next_alarm);
+    }
+    portEXIT_CRITICAL_ISR(&rf_sched->lock);
+
+    rf_metrics_record(RF_HIST_TX_LATENESS, (uint32_t)(edata->count_value - edata->alarm_value));
+    while (done_all) {
+        const uint8_t channel = __builtin_ctz(done_all);
+        if (rf_sched->channels[channel].callback)
+            rf_sched->channels[channel].callback(channel, ESP_OK, rf_sched->channels[channel].arg);
+        done_all &= done_all - 1;
+    }
+    return false;
+}
+
+esp_err_t rf_sched_tx_init(RFTxScheduler* rf_sched) {
+    ESP_RETURN_ON_FALSE(rf_sched, ESP_ERR_INVALID_ARG, TAG, "Invalid RF scheduler");
+    memset(rf_sched, 0, sizeof(RFTxScheduler));
+    rf_sched_init(&rf_sched->sched, RF_SCHED_MERGE_TICKS);
+    portMUX_INITIALIZE(&rf_sched->lock);
+
+    // Free running for the scheduler's lifetime, alarms are absolute ticks
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = DEFAULT_RESOLUTION,
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &rf_sched->timer));
+    gptimer_event_callbacks_t timer_cb = {
+        .on_alarm = sched_timer_callback,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(rf_sched->timer, &timer_cb, rf_sched));
+    ESP_ERROR_CHECK(gptimer_enable(rf_sched->timer));
+    ESP_ERROR_CHECK(gptimer_start(rf_sched->timer));
+    ESP_LOGI(TAG, "Scheduler timer started");
+    return ESP_OK;
+}
+
+esp_err_t rf_sched_tx_deinit(RFTxScheduler* rf_sched) {
+    ESP_RETURN_ON_FALSE(rf_sched && rf_sched->timer, ESP_ERR_INVALID_ARG, TAG, "Invalid RF scheduler");
+    ESP_ERROR_CHECK(rf_timer_deinit(rf_sched->timer));
+    rf_sched->timer = NULL;
+    for (uint8_t i = 0; i < rf_sched->channel_count; i++)
+        gpio_set_level(rf_sched->channels[i].gpio, 0);
+    return ESP_OK;
+}
+
+esp_err_t rf_sched_tx_add_pin(RFTxScheduler* rf_sched, gpio_num_t gpio, uint8_t* channel) {
+    ESP_RETURN_ON_FALSE(rf_sched && rf_sched->timer && channel, ESP_ERR_INVALID_ARG, TAG, "Invalid RF scheduler");
+    ESP_RETURN_ON_FALSE(rf_sched->channel_count < RF_SCHED_CHANNELS, ESP_ERR_NO_MEM, TAG, "No free scheduler channel");
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << gpio,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    gpio_set_level(gpio, 0);
+
+    *channel = rf_sched->channel_count;
+    rf_sched->channels[rf_sched->channel_count].gpio = gpio;
+    rf_sched->channels[rf_sched->channel_count++].pin_mask = 1ULL << gpio;
+    return ESP_OK;
+}
+
+esp_err_t rf_sched_tx_send(RFTxScheduler* rf_sched, uint8_t channel, const RFPulse* pulses, size_t count,
+    uint8_t repeat, RFTxCallback callback, void* arg) {
+    ESP_RETURN_ON_FALSE(rf_sched && rf_sched->timer && channel < rf_sched->channel_count, ESP_ERR_INVALID_ARG, TAG, "Invalid RF scheduler");
+    ESP_RETURN_ON_FALSE(pulses && count > 0 && count <= RF_MAX_PULSES && repeat > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF data");
+
+    RFSchedTxChannel* ch = &rf_sched->channels[channel];
+    uint64_t now;
+    ESP_ERROR_CHECK(gptimer_get_raw_count(rf_sched->timer, &now));
+
+    portENTER_CRITICAL(&rf_sched->lock);
+    if (rf_sched->sched.channels[channel].active) {
+        portEXIT_CRITICAL(&rf_sched->lock);
+        ESP_LOGE(TAG, "Scheduler channel %u is busy", channel);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memcpy(ch->pulses, pulses, count * sizeof(RFPulse));
+    ch->callback = callback;
+    ch->arg = arg;
+    const uint64_t earliest = rf_sched_next(&rf_sched->sched);
+    rf_sched_start(&rf_sched->sched, channel, ch->pulses, count, repeat, now + RF_SCHED_LEAD_TICKS);
+    // Only a new earliest edge moves the pending alarm
+    if (now + RF_SCHED_LEAD_TICKS < earliest) {
+        gptimer_alarm_config_t alarm_config = {
+            .alarm_count = now + RF_SCHED_LEAD_TICKS,
+        };
+        gptimer_set_alarm_action(rf_sched->timer, &alarm_config);
+    }
+    portEXIT_CRITICAL(&rf_sched->lock);
+    return ESP_OK;
+}
+
+esp_err_t rf_sched_tx_send_code(RFTxScheduler* rf_sched, uint8_t channel, uint8_t proto_idx, const RFCode* code,
+    uint8_t bit_length, uint8_t repeat, RFTxCallback callback, void* arg) {
+    ESP_RETURN_ON_FALSE(code && proto_idx < rf_proto_count(), ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+
+    RFPulse pulses[RF_MAX_PULSES];
+    const size_t count = rf_encode_code(rf_proto_symbols(proto_idx), code, bit_length, pulses, RF_MAX_PULSES);
+    ESP_RETURN_ON_FALSE(count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+    return rf_sched_tx_send(rf_sched, channel, pulses, count, repeat, callback, arg);
+}
@@ -0,0 +1,115 @@
+#include <string.h>
+#include "rf_selftest.h"
+
+void rf_selftest_error_add(RFTxErrorStats* stats, int32_t error) {
+    const uint32_t magnitude = error < 0 ? -(uint32_t)error : (uint32_t)error;
+    stats->count++;
+    stats->sum += error;
+    if (magnitude > stats->max) stats->max = magnitude;
+    stats->hist[magnitude < RF_SELFTEST_BINS ? magnitude : RF_SELFTEST_BINS - 1]++;
+}
+
+uint32_t rf_selftest_percentile(const RFTxErrorStats* stats, uint32_t permille) {
+    const uint64_t target = ((uint64_t)stats->count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint32_t bin = 0; bin < RF_SELFTEST_BINS - 1; bin++) {
+        seen += stats->hist[bin];
+        if (seen >= target) return bin;
+    }
+    return stats->max;
+}
+
+// Level changes of the whole transmission, ticks from its start
+static size_t schedule_edges(const RFTxSchedule* schedule, const RFPulse* pulses, uint32_t* edges, size_t max_edges) {
+    size_t count = 0;
+    uint8_t level = 0;
+    for (uint8_t rep = 0; rep < schedule->repeat; rep++) {
+        for (uint16_t i = 0; i < schedule->count; i++) {
+            const RFPulse pulse = rf_tx_schedule_pulse(schedule, pulses, rep, i);
+            if (RF_PULSE_LEVEL(pulse) == level) continue;
+            if (count >= max_edges) return count;
+            edges[count++] = (uint32_t)rf_tx_schedule_offset(schedule, rep, i);
+            level = RF_PULSE_LEVEL(pulse);
+        }
+    }
+    if (level && count < max_edges) edges[count++] = (uint32_t)rf_tx_schedule_length(schedule);
+    return count;
+}
+
+uint32_t rf_selftest_compare(RFTxErrorStats* stats, const RFTxSchedule* schedule, const RFPulse* pulses,
+        const uint32_t* edges, size_t edge_count) {
+    static uint32_t expected[RF_SELFTEST_MAX_EDGES];
+    const size_t expected_count = schedule_edges(schedule, pulses, expected, RF_SELFTEST_MAX_EDGES);
+    const size_t count = edge_count < expected_count ? edge_count : expected_count;
+
+    // The first edge is the reference, the capture clock has no fixed relation to the schedule
+    for (size_t i = 1; i < count; i++)
+        rf_selftest_error_add(stats, (int32_t)((edges[i] - edges[0]) - (expected[i] - expected[0])));
+    return edge_count > expected_count ? edge_count - expected_count : expected_count - edge_count;
+}
+
+// Replay the capture as edge durations, like the receiver ISR measures them
+static bool capture_decodes(RFSimReceiver* rx, const uint32_t* edges, size_t edge_count, const RFCode* code,
+        uint8_t bit_length, uint32_t separation_limit) {
+    RFRecvFrame frame;
+    bool decoded = false;
+    int64_t time = 0;
+    rf_ring_flush(&rx->ring);
+    for (size_t i = 0; i <= edge_count; i++) {
+        // Idle lines before the first edge and after the last one
+        const uint32_t duration = i == 0 || i == edge_count ? 10 * separation_limit : edges[i] - edges[i - 1];
+        time += duration;
+        rf_sim_rx_edge(rx, duration, time);
+        while (rf_ring_pop(&rx->ring, &frame))
+            if (frame.bit_length == bit_length && rf_code_equal(&frame.code, code)) decoded = true;
+    }
+    return decoded;
+}
+
+void rf_selftest_run(const RFSelftestConfig* config, RFSelftestResult* result) {
+    static RFSimReceiver rx;
+    static RFTxSchedule schedule;
+    static uint32_t edges[RF_SELFTEST_MAX_EDGES];
+    memset(result, 0, sizeof(RFSelftestResult));
+    const uint8_t repeat = config->repeat ? config->repeat : 1;
+
+    RFSim rng;
+    const RFSimConfig rng_config = { .seed = config->seed };
+    rf_sim_init(&rng, &rng_config);
+    rf_sim_rx_init(&rx, config->protos, config->proto_count, config->tolerance, config->separation_limit, false, 0);
+
+    for (uint8_t p = 0; p < config->proto_count; p++) {
+        RFSymbolTable table;
+        if (!rf_symbol_table_build(&config->protos[p], &table)) continue;
+
+        for (uint8_t i = 0; i < config->codes_per_proto; i++) {
+            RFPulse pulses[RF_MAX_PULSES];
+            RFCode code;
+            const uint8_t bit_length = 24 + (i % 3) * 8;
+            const uint64_t value = ((uint64_t)rf_sim_rand(&rng) << 32) | rf_sim_rand(&rng);
+            rf_code_from_u64(&code, value & ((1ULL << bit_length) - 1));
+            const size_t count = rf_encode_code(&table, &code, bit_length, pulses, RF_MAX_PULSES);
+            rf_tx_schedule_build(&schedule, pulses, count, repeat, NULL);
+
+            result->transmissions++;
+            size_t edge_count = 0;
+            if (!config->send(config->ctx, pulses, count, repeat, edges, RF_SELFTEST_MAX_EDGES, &edge_count)) {
+                result->failed_sends++;
+                continue;
+            }
+            result->missing_edges += rf_selftest_compare(&result->error, &schedule, pulses, edges, edge_count);
+            if (capture_decodes(&rx, edges, edge_count, &code, bit_length, config->separation_limit))
+                result->decoded++;
+        }
+    }
+}
+
+void rf_selftest_print(const RFSelftestResult* r, FILE* out) {
+    fprintf(out, "{\"transmissions\":%lu,\"decoded\":%lu,\"failed_sends\":%lu,\"edges\":%lu,\"missing_edges\":%lu,"
+        "\"error_mean\":%.2f,\"error_p99\":%lu,\"error_max\":%lu,\"decode_rate\":%.4f}\n",
+        (unsigned long)r->transmissions, (unsigned long)r->decoded, (unsigned long)r->failed_sends,
+        (unsigned long)r->error.count, (unsigned long)r->missing_edges,
+        r->error.count ? (double)r->error.sum / r->error.count : 0.0,
+        (unsigned long)rf_selftest_percentile(&r->error, 990), (unsigned long)r->error.max,
+        r->transmissions ? (double)r->decoded / r->transmissions : 0.0);
+}
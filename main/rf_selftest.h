@@ -0,0 +1,61 @@
+#ifndef RF_SELFTEST_H
+#define RF_SELFTEST_H
+
+/* TX timing self-test: sends reference codes of every protocol, compares the captured edges against
+the transmit schedule and checks that the capture decodes. Depends on rf_core.h and rf_sim.h only,
+the platform supplies the send-and-capture step: rf_loopback on hardware, the GPTimer transmitter on the
+host shims in host_test */
+
+#include <stdio.h>
+#include "rf_sim.h"
+
+#define RF_SELFTEST_BINS 256        // Error histogram in ticks, the last bin is open ended
+#define RF_SELFTEST_MAX_EDGES 1024
+
+typedef struct {
+    uint32_t count;
+    int64_t sum;                    // Signed, captured minus scheduled
+    uint32_t max;
+    uint32_t hist[RF_SELFTEST_BINS];
+} RFTxErrorStats;
+
+/* Send the train repeat times back to back and store the tick of every level change seen on the pin,
+starting from idle low. Returns false if the transmission could not be made */
+typedef bool (*RFSelftestSend)(void* ctx, const RFPulse* pulses, size_t count, uint8_t repeat,
+    uint32_t* edges, size_t max_edges, size_t* edge_count);
+
+typedef struct {
+    const Protocol* protos;
+    uint8_t proto_count;
+    uint8_t tolerance;
+    uint32_t separation_limit;
+    uint8_t codes_per_proto;
+    uint8_t repeat;
+    uint32_t seed;
+    RFSelftestSend send;
+    void* ctx;
+} RFSelftestConfig;
+
+typedef struct {
+    RFTxErrorStats error;           // Per edge, relative to the first edge of each transmission
+    uint32_t transmissions, decoded;
+    uint32_t failed_sends, missing_edges;
+} RFSelftestResult;
+
+void rf_selftest_error_add(RFTxErrorStats* stats, int32_t error);
+
+// Absolute error in ticks below which permille of the edges fall
+uint32_t rf_selftest_percentile(const RFTxErrorStats* stats, uint32_t permille);
+
+/* Compare captured edge ticks with the level changes schedule makes from idle low.
+Returns the number of edges the counts differ by */
+uint32_t rf_selftest_compare(RFTxErrorStats* stats, const RFTxSchedule* schedule, const RFPulse* pulses,
+    const uint32_t* edges, size_t edge_count);
+
+// Not reentrant, the receiver model and buffers are static
+void rf_selftest_run(const RFSelftestConfig* config, RFSelftestResult* result);
+
+// One JSON object per line
+void rf_selftest_print(const RFSelftestResult* result, FILE* out);
+
+#endif // RF_SELFTEST_H
@@ -0,0 +1,194 @@
+#include <string.h>
+#include "rf_sim.h"
+
+uint32_t rf_sim_rand(RFSim* sim) {
+    // xorshift32, deterministic for a given seed
+    uint32_t x = sim->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->rng = x;
+    return x;
+}
+
+static bool sim_chance(RFSim* sim, uint16_t per_10000) {
+    return per_10000 && rf_sim_rand(sim) % 10000 < per_10000;
+}
+
+static void sim_deliver(RFSim* sim, uint32_t duration, RFSimEdgeCallback cb, void* ctx) {
+    sim->time += duration;
+    sim->edges++;
+    cb(ctx, duration, sim->time);
+}
+
+static void sim_edge(RFSim* sim, RFSimEdgeCallback cb, void* ctx) {
+    uint32_t duration = sim->since_edge;
+    sim->since_edge = 0;
+
+    if (sim->config.jitter && duration) {
+        const uint32_t span = duration * sim->config.jitter / 100;
+        if (span) duration = duration - span + rf_sim_rand(sim) % (2 * span + 1);
+    }
+
+    if (sim_chance(sim, sim->config.drop_rate)) {
+        sim->since_edge = duration;
+        sim->drops++;
+        return;
+    }
+
+    const uint32_t glitch = sim->config.glitch_ticks;
+    if (glitch && duration > 2 * glitch && sim_chance(sim, sim->config.glitch_rate)) {
+        const uint32_t before = 1 + rf_sim_rand(sim) % (duration - 2 * glitch);
+        sim_deliver(sim, before, cb, ctx);
+        sim_deliver(sim, glitch, cb, ctx);
+        duration -= before + glitch;
+        sim->glitches++;
+    }
+    sim_deliver(sim, duration, cb, ctx);
+}
+
+void rf_sim_init(RFSim* sim, const RFSimConfig* config) {
+    memset(sim, 0, sizeof(RFSim));
+    sim->config = *config;
+    sim->rng = config->seed ? config->seed : 1;
+}
+
+void rf_sim_play(RFSim* sim, const RFPulse* pulses, size_t count, uint8_t repeat,
+        RFSimEdgeCallback cb, void* ctx) {
+    for (uint8_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t level = RF_PULSE_LEVEL(pulses[i]);
+            if (level != sim->level) {
+                sim_edge(sim, cb, ctx);
+                sim->level = level;
+            }
+            sim->since_edge += RF_PULSE_TICKS(pulses[i]);
+        }
+    }
+}
+
+bool rf_sim_play_trace(RFSim* sim, const uint8_t* trace, size_t len, RFSimEdgeCallback cb, void* ctx) {
+    size_t pos = rf_trace_skip_header(trace, len);
+    while (pos < len) {
+        uint8_t level;
+        uint32_t duration;
+        const size_t used = rf_trace_get(&trace[pos], len - pos, &level, &duration);
+        if (!used) return false;
+        pos += used;
+        if (level != sim->level) {
+            sim_edge(sim, cb, ctx);
+            sim->level = level;
+        }
+        sim->since_edge += duration;
+    }
+    return true;
+}
+
+void rf_sim_noise(RFSim* sim, uint32_t edges, uint32_t min_ticks, uint32_t max_ticks,
+        RFSimEdgeCallback cb, void* ctx) {
+    for (uint32_t i = 0; i < edges; i++) {
+        sim->since_edge += min_ticks + rf_sim_rand(sim) % (max_ticks - min_ticks + 1);
+        sim_edge(sim, cb, ctx);
+        sim->level = !sim->level;
+    }
+}
+
+void rf_sim_idle(RFSim* sim, uint32_t ticks, RFSimEdgeCallback cb, void* ctx) {
+    if (sim->level) {
+        sim_edge(sim, cb, ctx);
+        sim->level = 0;
+    }
+    sim->since_edge += ticks;
+    sim_edge(sim, cb, ctx);
+    sim->level = 1;
+}
+
+void rf_sim_rx_init(RFSimReceiver* rx, const Protocol* protos, uint8_t proto_count, uint8_t tolerance,
+        uint32_t separation_limit, bool stream, uint8_t confirm) {
+    rx->protos = protos;
+    rx->tolerance = tolerance;
+    rx->stream = stream;
+    rf_framer_reset(&rx->framer, separation_limit);
+    rf_proto_index_build(&rx->index, protos, proto_count);
+    rf_stream_init(&rx->decoder, protos, proto_count, tolerance, separation_limit, confirm);
+    rf_ring_reset(&rx->ring);
+    rx->calib = NULL;
+    rf_glitch_reset(&rx->glitch, 0);
+    rf_rate_limit_reset(&rx->limit, 0, 0);
+    rx->mute = 0;
+    rx->muted_until = 0;
+    rx->edges = rx->processed = rx->mutes = 0;
+}
+
+void rf_sim_rx_set_frontend(RFSimReceiver* rx, uint32_t min_pulse, uint32_t window, uint32_t max_edges, uint32_t mute) {
+    rf_glitch_reset(&rx->glitch, min_pulse);
+    rf_rate_limit_reset(&rx->limit, window, max_edges);
+    rx->mute = mute;
+}
+
+void rf_sim_rx_edge(void* ctx, uint32_t duration, int64_t timestamp) {
+    RFSimReceiver* rx = (RFSimReceiver*)ctx;
+    RFRecvFrame frame = { 0 };
+    rx->edges++;
+
+    // Muted edges cost nothing, the first one after re-arming measures from the re-arm time
+    if (timestamp < rx->muted_until) return;
+    if (rx->muted_until && timestamp - duration < rx->muted_until) duration = timestamp - rx->muted_until;
+
+    if (rf_rate_limit_feed(&rx->limit, timestamp)) {
+        rx->muted_until = timestamp + rx->mute;
+        rx->mutes++;
+        rf_framer_reset(&rx->framer, rx->framer.separation_limit);
+        rf_glitch_reset(&rx->glitch, rx->glitch.min_pulse);
+        rf_rate_limit_reset(&rx->limit, rx->limit.window, rx->limit.max_edges);
+        rf_stream_reset(&rx->decoder);
+        return;
+    }
+    rx->processed++;
+
+    if (rx->glitch.min_pulse) {
+        const uint32_t raw = duration;
+        if (!rf_glitch_feed(&rx->glitch, raw, &duration)) return;
+        timestamp -= raw;
+    }
+
+    if (rx->stream) {
+        if (rf_stream_feed(&rx->decoder, duration, timestamp, &frame))
+            rf_ring_push(&rx->ring, &frame);
+        return;
+    }
+
+    if (rf_framer_closes(&rx->framer, rx->timings, duration)) {
+        const bool decoded = rx->calib
+            ? rf_decode_calibrated(rx->calib, &rx->index, rx->protos, rx->timings, rx->framer.edge_count, rx->tolerance, &frame, NULL)
+            : rf_decode_batch(&rx->index, rx->protos, rx->timings, rx->framer.edge_count, rx->tolerance, &frame, NULL);
+        if (decoded) {
+            frame.timestamp = timestamp - duration;
+            rf_ring_push(&rx->ring, &frame);
+        }
+    }
+    rf_framer_push(&rx->framer, rx->timings, duration);
+}
+
+void rf_sim_capture_init(RFSimCapture* cap, RFPulse* pulses, size_t max_pulses, int64_t time) {
+    cap->pulses = pulses;
+    cap->count = 0;
+    cap->max_pulses = max_pulses;
+    cap->level = 0;
+    cap->last_time = time;
+}
+
+bool rf_sim_capture_level(RFSimCapture* cap, uint8_t level, int64_t time) {
+    level = level ? 1 : 0;
+    if (level == cap->level) return true;
+
+    // A level change ends the pulse of the previous level, the idle low before the first one is not kept
+    if (cap->level || cap->count) {
+        if (cap->count >= cap->max_pulses) return false;
+        const int64_t ticks = time - cap->last_time;
+        cap->pulses[cap->count++] = RF_PULSE(cap->level, ticks > RF_PULSE_MAX_TICKS ? RF_PULSE_MAX_TICKS : ticks);
+    }
+    cap->level = level;
+    cap->last_time = time;
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef RF_SIM_H
+#define RF_SIM_H
+
+// Edge-level model of the radio link for exercising the core without hardware, depends on rf_core.h only
+
+#include "rf_core.h"
+
+typedef struct {
+    uint32_t seed;
+    uint8_t jitter;          // Maximum deviation of every edge duration in percent
+    uint16_t glitch_rate;    // Noise spikes per 10000 edges, a spike splits the edge in three
+    uint16_t drop_rate;      // Missed edges per 10000, a missed edge merges into the next one
+    uint16_t glitch_ticks;   // Length of a noise spike
+} RFSimConfig;
+
+typedef struct {
+    RFSimConfig config;
+    uint32_t rng;
+    uint8_t level;
+    uint32_t since_edge;     // Line time accumulated since the last delivered edge
+    int64_t time;            // Timestamp of the last delivered edge
+    uint32_t edges, glitches, drops;
+} RFSim;
+
+// Receives every edge as the duration since the previous one, like the receiver ISR measures it
+typedef void (*RFSimEdgeCallback)(void* ctx, uint32_t duration, int64_t timestamp);
+
+void rf_sim_init(RFSim* sim, const RFSimConfig* config);
+
+// Next value of the simulator's deterministic generator
+uint32_t rf_sim_rand(RFSim* sim);
+
+/* Play a pulse train repeat times. Edges are delivered on level changes, so the last pulse
+of the train is only seen when the line changes again (next train or rf_sim_idle) */
+void rf_sim_play(RFSim* sim, const RFPulse* pulses, size_t count, uint8_t repeat,
+    RFSimEdgeCallback cb, void* ctx);
+
+// Random edges with durations in [min_ticks, max_ticks], like a receiver outputs with no carrier
+void rf_sim_noise(RFSim* sim, uint32_t edges, uint32_t min_ticks, uint32_t max_ticks,
+    RFSimEdgeCallback cb, void* ctx);
+
+/* Play a recorded trace (see rf_trace_put) once, with the simulator's impairments on top.
+Returns false if the trace is malformed */
+bool rf_sim_play_trace(RFSim* sim, const uint8_t* trace, size_t len, RFSimEdgeCallback cb, void* ctx);
+
+// Keep the line low for ticks, then deliver the pending edge as if noise resumed
+void rf_sim_idle(RFSim* sim, uint32_t ticks, RFSimEdgeCallback cb, void* ctx);
+
+/* Receiver running the firmware framer and decoders synchronously, decoded frames go to ring.
+rf_sim_rx_edge is an RFSimEdgeCallback with the receiver as ctx */
+typedef struct {
+    const Protocol* protos;
+    uint8_t tolerance;
+    bool stream;
+    RFFramer framer;
+    uint32_t timings[MAX_EDGES];
+    RFProtoIndex index;
+    RFStreamDecoder decoder;
+    RFRecvRing ring;
+    RFCalibration* calib;   // Batch decoding goes through rf_decode_calibrated when set
+
+    // Front-end, same semantics as rf_recv_set_frontend
+    RFGlitchFilter glitch;
+    RFRateLimit limit;
+    uint32_t mute;
+    int64_t muted_until;
+    uint32_t edges, processed, mutes;   // processed: edges that reached the decoders
+} RFSimReceiver;
+
+void rf_sim_rx_init(RFSimReceiver* rx, const Protocol* protos, uint8_t proto_count, uint8_t tolerance,
+    uint32_t separation_limit, bool stream, uint8_t confirm);
+
+// Edges beyond max_edges per window mute the receiver for mute ticks, min_pulse drops glitches
+void rf_sim_rx_set_frontend(RFSimReceiver* rx, uint32_t min_pulse, uint32_t window, uint32_t max_edges, uint32_t mute);
+
+void rf_sim_rx_edge(void* ctx, uint32_t duration, int64_t timestamp);
+
+// Rebuilds the pulse train driven onto a pin from the level changes a GPIO shim reports
+typedef struct {
+    RFPulse* pulses;
+    size_t count, max_pulses;
+    uint8_t level;
+    int64_t last_time;
+} RFSimCapture;
+
+void rf_sim_capture_init(RFSimCapture* cap, RFPulse* pulses, size_t max_pulses, int64_t time);
+
+// Returns false once the buffer is full
+bool rf_sim_capture_level(RFSimCapture* cap, uint8_t level, int64_t time);
+
+#endif // RF_SIM_H
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "rf_core.h"
+
+// Identical frames further apart than this start a new confirmation run
+#define RF_STREAM_REPEAT_WINDOW 200000
+
+static inline uint32_t RF_IRAM_ATTR diff(uint32_t a, uint32_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+static void RF_IRAM_ATTR stream_start(const RFStreamDecoder* dec, const RFProtoTiming* timing, RFStreamState* st, uint32_t gap) {
+    // Runs for every enabled protocol on every gap, so no divisions
+    st->delay = (uint32_t)(((uint64_t)gap * timing->sync_recip) >> 16);
+    st->tolerance = (st->delay * dec->tolerance_q16) >> 16;
+    st->zero_high = st->delay * timing->zero.high;
+    st->zero_low = st->delay * timing->zero.low;
+    st->one_high = st->delay * timing->one.high;
+    st->one_low = st->delay * timing->one.low;
+    rf_accum_reset(&st->code);
+    st->deviation = 0;
+    st->has_first = false;
+    // Inverted protocols have the short half of the sync between the gap and the first bit
+    st->phase = timing->inverted ? RF_STREAM_SKIP : RF_STREAM_DATA;
+}
+
+/* A frame is complete when it carries enough bits and ends where the sync does:
+on a pending sync high for normal protocols, on a whole pair for inverted ones */
+static bool RF_IRAM_ATTR stream_complete(const RFProtoTiming* timing, const RFStreamState* st) {
+    if (st->phase != RF_STREAM_DATA || st->code.bits < 3) return false;
+    return timing->inverted ? !st->has_first : st->has_first;
+}
+
+static void RF_IRAM_ATTR stream_edge(RFStreamState* st, uint32_t duration) {
+    switch (st->phase) {
+        case RF_STREAM_SKIP:
+            st->phase = RF_STREAM_DATA;
+            break;
+        case RF_STREAM_DATA:
+            if (!st->has_first) {
+                st->first = duration;
+                st->has_first = true;
+                break;
+            }
+            st->has_first = false;
+            if (st->code.bits >= RF_MAX_CODE_BITS) {
+                st->phase = RF_STREAM_IDLE;
+            } else if (diff(st->first, st->zero_high) < st->tolerance && diff(duration, st->zero_low) < st->tolerance) {
+                rf_accum_push(&st->code, 0);
+                st->deviation += diff(st->first, st->zero_high) + diff(duration, st->zero_low);
+            } else if (diff(st->first, st->one_high) < st->tolerance && diff(duration, st->one_low) < st->tolerance) {
+                rf_accum_push(&st->code, 1);
+                st->deviation += diff(st->first, st->one_high) + diff(duration, st->one_low);
+            } else {
+                st->phase = RF_STREAM_IDLE;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void rf_stream_init(RFStreamDecoder* dec, const Protocol* protos, uint8_t proto_count,
+        uint8_t tolerance, uint32_t separation_limit, uint8_t confirm) {
+    dec->protos = protos;
+    dec->proto_count = proto_count > RF_MAX_PROTOCOLS ? RF_MAX_PROTOCOLS : proto_count;
+    dec->tolerance = tolerance;
+    dec->separation_limit = separation_limit;
+    dec->confirm = confirm;
+    dec->tolerance_q16 = ((uint32_t)tolerance * 65536 + 99) / 100;
+    for (uint8_t i = 0; i < dec->proto_count; i++)
+        rf_proto_compile(&protos[i], &dec->timing[i]);
+    rf_stream_enable(dec, UINT32_MAX);
+}
+
+void rf_stream_enable(RFStreamDecoder* dec, uint32_t enabled) {
+    dec->active_count = 0;
+    for (uint8_t i = 0; i < dec->proto_count; i++)
+        if (enabled & (1UL << i)) dec->active[dec->active_count++] = i;
+    rf_stream_reset(dec);
+}
+
+void rf_stream_reset(RFStreamDecoder* dec) {
+    for (uint8_t i = 0; i < RF_MAX_PROTOCOLS; i++)
+        dec->state[i].phase = RF_STREAM_IDLE;
+    memset(&dec->last, 0, sizeof(dec->last));
+    dec->repeats = 0;
+}
+
+bool RF_IRAM_ATTR rf_stream_feed(RFStreamDecoder* dec, uint32_t duration, int64_t timestamp, RFRecvFrame* frame) {
+    if (duration <= dec->separation_limit) {
+        for (uint8_t a = 0; a < dec->active_count; a++) {
+            RFStreamState* st = &dec->state[dec->active[a]];
+            if (st->phase != RF_STREAM_IDLE) stream_edge(st, duration);
+        }
+        return false;
+    }
+
+    // Gap: closes the running frame and is the sync of the next one, the closest fit wins
+    bool found = false;
+    uint8_t candidates = 0;
+    uint32_t best_dev = UINT32_MAX;
+    for (uint8_t a = 0; a < dec->active_count; a++) {
+        const uint8_t i = dec->active[a];
+        RFStreamState* st = &dec->state[i];
+        if (stream_complete(&dec->timing[i], st)) {
+            const uint32_t pulses = (uint32_t)st->code.bits * 2;
+            const uint32_t mean_dev = st->delay ? st->deviation * 100 / (pulses * st->delay) : 100;
+            candidates++;
+            if (mean_dev < best_dev) {
+                best_dev = mean_dev;
+                rf_accum_finish(&st->code, &frame->code);
+                frame->delay = st->delay;
+                frame->timestamp = timestamp - duration;
+                frame->bit_length = st->code.bits;
+                frame->proto = i;
+                frame->quality = mean_dev >= 100 ? 0 : 100 - mean_dev;
+                found = true;
+            }
+        }
+        stream_start(dec, &dec->timing[i], st, duration);
+    }
+    frame->candidates = candidates;
+    if (!found) return false;
+
+    if (dec->confirm <= 1) return true;
+
+    const bool same = dec->repeats > 0 && rf_code_equal(&frame->code, &dec->last.code) && frame->proto == dec->last.proto &&
+        frame->bit_length == dec->last.bit_length && frame->timestamp - dec->last.timestamp < RF_STREAM_REPEAT_WINDOW;
+    dec->repeats = same ? (dec->repeats < UINT8_MAX ? dec->repeats + 1 : dec->repeats) : 1;
+    dec->last = *frame;
+    // Report once per run, when the run reaches the confirmation count
+    return dec->repeats == dec->confirm;
+}
@@ -1,39 +1,57 @@
 #include "rf_common.h"
+#include "rf_metrics.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static bool IRAM_ATTR rf_timer_callback(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     RFTransmitter* rf_rmt = (RFTransmitter*)arg;
-    if (rf_rmt->tx_active) {
-        if (rf_rmt->pulse_index < rf_rmt->pulse_count) {
-            gpio_set_level(rf_rmt->tx_gpio, rf_rmt->pulses[rf_rmt->pulse_index].level);
+    rf_metrics_record(RF_HIST_TX_LATENESS, (uint32_t)(edata->count_value - edata->alarm_value));
+    if (!rf_rmt->tx_active) return false;
 
-            gptimer_alarm_config_t next_alarm = {
-                .alarm_count = edata->alarm_value + rf_rmt->pulses[rf_rmt->pulse_index].pulse_length,
-            };
-            gptimer_set_alarm_action(timer, &next_alarm);
+    const RFTxSchedule* schedule = &rf_rmt->tx_schedule;
+    if (rf_rmt->tx_in_gap) {
+        // Gap before a queued item is over, its schedule starts at this alarm
+        rf_rmt->tx_in_gap = false;
+        rf_rmt->tx_base = edata->alarm_value;
+        rf_rmt->current_rep = 0;
+        rf_rmt->pulse_index = 0;
+    } else if (rf_rmt->pulse_index == 0 && rf_rmt->current_rep < schedule->repeat) {
+        rf_metrics_record(RF_HIST_TX_BOUNDARY,
+            (uint32_t)(edata->count_value - rf_rmt->tx_base - rf_tx_schedule_offset(schedule, rf_rmt->current_rep, 0)));
+    }
 
-            rf_rmt->pulse_index++;
+    if (rf_rmt->current_rep < schedule->repeat) {
+        // Alarms come from the schedule, not the previous alarm, so latency never accumulates across repeats
+        gpio_set_level(rf_rmt->tx_gpio, RF_PULSE_LEVEL(rf_tx_schedule_pulse(schedule, rf_rmt->pulses, rf_rmt->current_rep, rf_rmt->pulse_index)));
+        gptimer_alarm_config_t next_alarm = {
+            .alarm_count = rf_rmt->tx_base + rf_tx_schedule_offset(schedule, rf_rmt->current_rep, rf_rmt->pulse_index + 1),
+        };
+        gptimer_set_alarm_action(timer, &next_alarm);
+        if (++rf_rmt->pulse_index == schedule->count) {
+            rf_rmt->pulse_index = 0;
+            rf_rmt->current_rep++;
+        }
+    } else {
+        gpio_set_level(rf_rmt->tx_gpio, 0);
+        rf_rmt->pulse_index = 0;
+        rf_rmt->current_rep = 0;
+        if (rf_rmt->tx_duplex && rf_rmt->rx) rf_recv_echo_end(rf_rmt->rx);
+        rf_metrics_record(RF_HIST_TX_SEND_US, (uint32_t)(esp_timer_get_time() - rf_rmt->tx_start));
+
+        // Next queued item follows straight from here, the task is only told once the queue is empty
+        uint32_t gap_us;
+        if (rf_tx_queue_advance(rf_rmt, &gap_us)) {
+            rf_rmt->tx_in_gap = true;
+            gptimer_alarm_config_t gap_alarm = {
+                .alarm_count = edata->alarm_value + gap_us,
+            };
+            gptimer_set_alarm_action(timer, &gap_alarm);
         } else {
             gptimer_stop(timer);
             gptimer_set_raw_count(timer, 0);
-            gpio_set_level(rf_rmt->tx_gpio, 0);
-            rf_rmt->pulse_index = 0;
-            rf_rmt->current_rep++;
-            if (rf_rmt->current_rep < rf_rmt->repeat_count) {
-                gpio_set_level(rf_rmt->tx_gpio, 1);
-                gptimer_alarm_config_t alarm_config = {
-                    .alarm_count = rf_rmt->pulses[rf_rmt->pulse_index].pulse_length,
-                };
-                gptimer_set_alarm_action(timer, &alarm_config);
-                gptimer_start(timer);
-                rf_rmt->pulse_index++;
-            } else {
-                rf_rmt->tx_active = false;
-                rf_rmt->current_rep = 0;
-                if (rf_rmt->rf_trans_handle)
-                    vTaskNotifyGiveFromISR(rf_rmt->rf_trans_handle, &xHigherPriorityTaskWoken);
-            }
+            if (rf_rmt->rf_trans_handle)
+                vTaskNotifyGiveFromISR(rf_rmt->rf_trans_handle, &xHigherPriorityTaskWoken);
         }
     }
 
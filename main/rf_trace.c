@@ -0,0 +1,76 @@
+#include <string.h>
+#include "rf_core.h"
+
+size_t RF_IRAM_ATTR rf_trace_put(uint8_t* out, uint8_t level, uint32_t duration) {
+    uint64_t value = (uint64_t)duration << 1 | (level & 1);
+    size_t len = 0;
+    do {
+        const uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[len++] = value ? byte | 0x80 : byte;
+    } while (value);
+    return len;
+}
+
+size_t rf_trace_get(const uint8_t* in, size_t len, uint8_t* level, uint32_t* duration) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < len && i < RF_TRACE_MAX_RECORD; i++) {
+        value |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) {
+            if (value >> 33) return 0;
+            *level = value & 1;
+            *duration = (uint32_t)(value >> 1);
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+size_t rf_trace_skip_header(const uint8_t* trace, size_t len) {
+    return len >= RF_TRACE_HEADER && memcmp(trace, RF_TRACE_MAGIC, RF_TRACE_HEADER) == 0 ? RF_TRACE_HEADER : 0;
+}
+
+size_t rf_trace_to_pulses(const uint8_t* trace, size_t len, RFPulse* pulses, size_t max_pulses) {
+    size_t pos = rf_trace_skip_header(trace, len), count = 0;
+    while (pos < len) {
+        uint8_t level;
+        uint32_t duration;
+        const size_t used = rf_trace_get(&trace[pos], len - pos, &level, &duration);
+        if (!used || count >= max_pulses) return 0;
+        pos += used;
+        pulses[count++] = RF_PULSE(level, duration > RF_PULSE_MAX_TICKS ? RF_PULSE_MAX_TICKS : duration);
+    }
+    return count;
+}
+
+void rf_trace_ring_init(RFTraceRing* ring, uint8_t* buf, uint32_t size) {
+    ring->buf = buf;
+    ring->size = size;
+    __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, 0, __ATOMIC_RELAXED);
+    ring->dropped = 0;
+}
+
+bool RF_IRAM_ATTR rf_trace_ring_push(RFTraceRing* ring, uint8_t level, uint32_t duration) {
+    uint8_t record[RF_TRACE_MAX_RECORD];
+    const size_t len = rf_trace_put(record, level, duration);
+    const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    if (ring->size - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < len) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+        ring->buf[(head + i) & (ring->size - 1)] = record[i];
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t rf_trace_ring_read(RFTraceRing* ring, uint8_t* out, size_t max) {
+    const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    const uint32_t avail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    const size_t len = avail < max ? avail : max;
+    for (size_t i = 0; i < len; i++)
+        out[i] = ring->buf[(tail + i) & (ring->size - 1)];
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+    return len;
+}
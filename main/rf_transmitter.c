@@ -1,70 +1,57 @@
 #include <stdio.h>
 #include <string.h>
 #include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "esp_check.h"
 #include "freertos/FreeRTOS.h"
 
 
+void rf_tx_pulses_save(RFTransmitter* rf_rmt) {
+    if (rf_rmt->saved) return;
+    memcpy(rf_rmt->saved_pulses, rf_rmt->pulses, rf_rmt->pulse_count * sizeof(RFPulse));
+    rf_rmt->saved_count = rf_rmt->pulse_count;
+    rf_rmt->saved = true;
+}
+
+void rf_tx_pulses_restore(RFTransmitter* rf_rmt) {
+    if (!rf_rmt->saved) return;
+    memcpy(rf_rmt->pulses, rf_rmt->saved_pulses, rf_rmt->saved_count * sizeof(RFPulse));
+    rf_rmt->pulse_count = rf_rmt->saved_count;
+    rf_rmt->saved = false;
+}
+
 esp_err_t translate_tristate(const char* data, RFTransmitter* rf_rmt) {
-    const char* log_data = data;
     ESP_RETURN_ON_FALSE(rf_rmt && data, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
-    if (rf_rmt->pulses) {
-        free(rf_rmt->pulses);
-        rf_rmt->pulses = NULL;
-    }
-    rf_rmt->pulse_count = strlen(data) * 4 + 2;
-    rf_rmt->pulses = malloc(rf_rmt->pulse_count * sizeof(RFPulse));
-    const Protocol* proto = rf_rmt->proto;
-    int idx = 0;
-
-    uint8_t firstLogic = proto->inverted ? 0 : 1;
-    uint8_t secondLogic = proto->inverted ? 1 : 0;
-    while (*data) {
-        if (*data == '0') {
-            rf_rmt->pulses[idx].level = firstLogic;
-            rf_rmt->pulses[idx].pulse_length = proto->zero.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 1].level = secondLogic;
-            rf_rmt->pulses[idx + 1].pulse_length = proto->zero.low * proto->pulse_length;
-
-            rf_rmt->pulses[idx + 2].level = firstLogic;
-            rf_rmt->pulses[idx + 2].pulse_length = proto->zero.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 3].level = secondLogic;
-            rf_rmt->pulses[idx + 3].pulse_length = proto->zero.low * proto->pulse_length;
-        } else if (*data == '1') {
-            rf_rmt->pulses[idx].level = firstLogic;
-            rf_rmt->pulses[idx].pulse_length = proto->one.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 1].level = secondLogic;
-            rf_rmt->pulses[idx + 1].pulse_length = proto->one.low * proto->pulse_length;
-
-            rf_rmt->pulses[idx + 2].level = firstLogic;
-            rf_rmt->pulses[idx + 2].pulse_length = proto->one.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 3].level = secondLogic;
-            rf_rmt->pulses[idx + 3].pulse_length = proto->one.low * proto->pulse_length;
-        } else if (*data == 'F') {
-            rf_rmt->pulses[idx].level = firstLogic;
-            rf_rmt->pulses[idx].pulse_length = proto->zero.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 1].level = secondLogic;
-            rf_rmt->pulses[idx + 1].pulse_length = proto->zero.low * proto->pulse_length;
-
-            rf_rmt->pulses[idx + 2].level = firstLogic;
-            rf_rmt->pulses[idx + 2].pulse_length = proto->one.high * proto->pulse_length;
-            rf_rmt->pulses[idx + 3].level = secondLogic;
-            rf_rmt->pulses[idx + 3].pulse_length = proto->one.low * proto->pulse_length;
-        } else {
-            ESP_LOGE(TAG, "Invalid data: %c", *data);
-            return ESP_ERR_INVALID_ARG;
-        }
-        idx += 4;
-        data++;
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+    rf_rmt->saved = false;
+
+    const size_t pulse_count = rf_encode_tristate(&rf_rmt->tx_table, data, rf_rmt->pulses, RF_MAX_PULSES);
+    if (pulse_count == 0) {
+        ESP_LOGE(TAG, "Invalid data: %s", data);
+        return ESP_ERR_INVALID_ARG;
     }
+    rf_rmt->pulse_count = pulse_count;
+
+    ESP_LOGI(TAG, "Data %s translated to %d pulses", data, rf_rmt->pulse_count);
+
+    return ESP_OK;
+}
 
-    rf_rmt->pulses[idx].level = firstLogic;
-    rf_rmt->pulses[idx].pulse_length = proto->sync_factor.high * proto->pulse_length;
-    rf_rmt->pulses[idx + 1].level = secondLogic;
-    rf_rmt->pulses[idx + 1].pulse_length = proto->sync_factor.low * proto->pulse_length;
+esp_err_t translate_binary(const RFCode* code, uint8_t bit_length, RFTransmitter* rf_rmt) {
+    ESP_RETURN_ON_FALSE(rf_rmt && code, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+    rf_rmt->saved = false;
 
-    ESP_LOGI(TAG, "Data %s translated to %d pulses", log_data, rf_rmt->pulse_count);
+    const size_t pulse_count = rf_encode_code(&rf_rmt->tx_table, code, bit_length, rf_rmt->pulses, RF_MAX_PULSES);
+    if (pulse_count == 0) {
+        ESP_LOGE(TAG, "Invalid bit length: %d", bit_length);
+        return ESP_ERR_INVALID_ARG;
+    }
+    rf_rmt->pulse_count = pulse_count;
+
+    ESP_LOGI(TAG, "%d bits translated to %d pulses", bit_length, rf_rmt->pulse_count);
 
     return ESP_OK;
 }
@@ -88,13 +75,38 @@ esp_err_t rf_init(gpio_num_t tx_gpio, int8_t repeat_count, Protocol* tx_proto, R
     rf_rmt->repeat_count = repeat_count;
     rf_rmt->proto = tx_proto;
 
-    rf_rmt->pulses = NULL;
+    // Reuse the precomputed table when the protocol is in the protocol table
+    bool table_found = false;
+    for (uint8_t i = 0; i < rf_proto_count() && !table_found; i++) {
+        if (memcmp(tx_proto, rf_proto_get(i), sizeof(Protocol)) == 0) {
+            rf_rmt->tx_table = *rf_proto_symbols(i);
+            table_found = true;
+        }
+    }
+    if (!table_found)
+        ESP_RETURN_ON_FALSE(rf_symbol_table_build(tx_proto, &rf_rmt->tx_table), ESP_ERR_INVALID_ARG, TAG, "Protocol pulses exceed the pulse format");
+
+    rf_rmt->pulse_count = 0;
+    rf_rmt->saved = false;
     rf_rmt->tx_active = false;
+    rf_rmt->tx_in_gap = false;
+    rf_rmt->tx_queue_count = 0;
+    rf_rmt->tx_current_valid = false;
+    rf_rmt->tx_seq = 0;
+    rf_rmt->tx_next_id = 1;
+    memset(&rf_rmt->tx_stats, 0, sizeof(rf_rmt->tx_stats));
+    portMUX_INITIALIZE(&rf_rmt->tx_lock);
+    rf_rmt->tx_cache = NULL;
+    rf_rmt->tx_final = false;
 
-    rf_rmt->rx_gpio = GPIO_NUM_NC;
-    rf_rmt->rx_gpio_state = GPIO_NUM_NC;
+    rf_rmt->tx_backend = RF_TX_BACKEND_GPTIMER;
+    rf_rmt->tx_chan = NULL;
+    rf_rmt->tx_encoder = NULL;
+    rf_rmt->rmt_pending = 0;
 
-    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    rf_rmt->rx = NULL;
+    rf_rmt->tx_duplex = false;
+    rf_rmt->rf_trans_handle = NULL;
 
     ESP_ERROR_CHECK(rf_timer_init(rf_rmt));
 
@@ -106,10 +118,9 @@ esp_err_t rf_init(gpio_num_t tx_gpio, int8_t repeat_count, Protocol* tx_proto, R
 
 esp_err_t rf_deinit(RFTransmitter* rf_rmt) {
     ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF module");
-    if (rf_rmt->pulses) {
-        free(rf_rmt->pulses);
-        rf_rmt->pulses = NULL;
-    }
+    if (rf_rmt->tx_backend == RF_TX_BACKEND_RMT)
+        ESP_ERROR_CHECK(rf_rmt_tx_deinit(rf_rmt));
+
     rf_rmt->pulse_count = 0;
     rf_rmt->pulse_index = 0;
 
@@ -125,36 +136,142 @@ esp_err_t rf_deinit(RFTransmitter* rf_rmt) {
     gpio_reset_pin(rf_rmt->tx_gpio);
     rf_rmt->tx_gpio = GPIO_NUM_NC;
 
-    ESP_ERROR_CHECK(rf_recv_deinit(rf_rmt, false));
-    gpio_uninstall_isr_service();
+    rf_rmt->rx = NULL;
 
     rf_rmt->init = false;
     ESP_LOGI(TAG, "RF module deinitialized");
     return ESP_OK;
 }
 
-esp_err_t rf_send(RFTransmitter* rf_rmt) {
+esp_err_t rf_set_duplex(RFTransmitter* rf_rmt, bool enable) {
     ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
-    ESP_RETURN_ON_FALSE(rf_rmt->pulses && rf_rmt->pulse_count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF data");
-    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+
+    rf_rmt->tx_duplex = enable;
+    return ESP_OK;
+}
+
+esp_err_t rf_set_receiver(RFTransmitter* rf_rmt, RFReceiver* rf_recv) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_recv || rf_recv->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF receiver");
+
+    rf_rmt->rx = rf_recv;
+    return ESP_OK;
+}
+
+esp_err_t rf_set_final_sync(RFTransmitter* rf_rmt, const RFPulse* sync) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+
+    rf_rmt->tx_final = sync != NULL;
+    if (sync) {
+        rf_rmt->tx_final_sync[0] = sync[0];
+        rf_rmt->tx_final_sync[1] = sync[1];
+    }
+    return ESP_OK;
+}
 
+void IRAM_ATTR rf_tx_schedule_load(RFTransmitter* rf_rmt) {
+    rf_tx_schedule_build(&rf_rmt->tx_schedule, rf_rmt->pulses, rf_rmt->pulse_count,
+        rf_rmt->tx_repeats ? rf_rmt->tx_repeats : 1, rf_rmt->tx_final ? rf_rmt->tx_final_sync : NULL);
+}
+
+void IRAM_ATTR rf_tx_echo_begin(RFTransmitter* rf_rmt, uint32_t lead_us) {
+    // Every repeat and the final sync, as the timer will send them
+    rf_recv_echo_begin(rf_rmt->rx, lead_us + (uint32_t)rf_tx_schedule_length(&rf_rmt->tx_schedule));
+}
+
+esp_err_t rf_send_start(RFTransmitter* rf_rmt) {
     ESP_LOGI(TAG, "Starting RF transmission");
-    if (rf_rmt->rx_gpio != GPIO_NUM_NC) {
-        rf_rmt->rx_gpio_state = rf_rmt->rx_gpio;
-        ESP_ERROR_CHECK(rf_recv_deinit(rf_rmt, true));
+    rf_tx_schedule_load(rf_rmt);
+    if (rf_rmt->rx && rf_rmt->rx->rx_gpio != GPIO_NUM_NC) {
+        if (rf_rmt->tx_duplex) rf_tx_echo_begin(rf_rmt, 0);
+        else ESP_ERROR_CHECK(rf_recv_deinit(rf_rmt->rx, true));
+    }
+
+    rf_metrics_inc(RF_METRIC_TX_SENDS);
+    rf_rmt->tx_start = esp_timer_get_time();
+    if (rf_rmt->tx_backend == RF_TX_BACKEND_RMT) {
+        const esp_err_t err = rf_rmt_tx_send(rf_rmt);
+        if (err != ESP_OK && rf_rmt->tx_duplex && rf_rmt->rx) rf_recv_echo_end(rf_rmt->rx);
+        return err;
     }
 
     rf_rmt->tx_active = true;
+    rf_rmt->tx_in_gap = false;
     rf_rmt->current_rep = 0;
-    rf_rmt->pulse_index = 0;
+    rf_rmt->pulse_index = 1;
+    rf_rmt->tx_base = 0;
 
-    gpio_set_level(rf_rmt->tx_gpio, rf_rmt->pulses[rf_rmt->pulse_index].level);
+    // The timer is stopped at 0 between sends, the schedule starts with its first pulse right now
+    gpio_set_level(rf_rmt->tx_gpio, RF_PULSE_LEVEL(rf_tx_schedule_pulse(&rf_rmt->tx_schedule, rf_rmt->pulses, 0, 0)));
     gptimer_alarm_config_t alarm_config = {
-        .alarm_count = rf_rmt->pulses[rf_rmt->pulse_index].pulse_length,
+        .alarm_count = rf_tx_schedule_offset(&rf_rmt->tx_schedule, 0, 1),
     };
     gptimer_set_alarm_action(rf_rmt->timer, &alarm_config);
+    if (rf_rmt->pulse_index == rf_rmt->tx_schedule.count) {
+        rf_rmt->pulse_index = 0;
+        rf_rmt->current_rep++;
+    }
     gptimer_start(rf_rmt->timer);
-    rf_rmt->pulse_index++;
 
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+static esp_err_t send_pulses(RFTransmitter* rf_rmt) {
+    rf_rmt->tx_repeats = rf_rmt->repeat_count;
+    return rf_send_start(rf_rmt);
+}
+
+esp_err_t rf_send(RFTransmitter* rf_rmt) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+    // Back to the configured train after a one-off code
+    rf_tx_pulses_restore(rf_rmt);
+    ESP_RETURN_ON_FALSE(rf_rmt->pulse_count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF data");
+
+    return send_pulses(rf_rmt);
+}
+
+esp_err_t rf_send_code(RFTransmitter* rf_rmt, uint64_t value, uint8_t bit_length, uint8_t proto_idx) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(proto_idx < rf_proto_count() && bit_length <= 64, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+
+    RFCode code;
+    rf_code_from_u64(&code, value);
+    rf_tx_pulses_save(rf_rmt);
+    const size_t pulse_count = rf_encode_code(rf_proto_symbols(proto_idx), &code, bit_length, rf_rmt->pulses, RF_MAX_PULSES);
+    if (pulse_count == 0) rf_tx_pulses_restore(rf_rmt);
+    ESP_RETURN_ON_FALSE(pulse_count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+    rf_rmt->pulse_count = pulse_count;
+
+    return send_pulses(rf_rmt);
+}
+
+esp_err_t rf_send_tristate(RFTransmitter* rf_rmt, uint64_t packed, uint8_t symbol_count, uint8_t proto_idx) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(proto_idx < rf_proto_count(), ESP_ERR_INVALID_ARG, TAG, "Invalid RF protocol");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+
+    rf_tx_pulses_save(rf_rmt);
+    const size_t pulse_count = rf_encode_tristate_packed(rf_proto_symbols(proto_idx), packed, symbol_count,
+        rf_rmt->pulses, RF_MAX_PULSES);
+    if (pulse_count == 0) rf_tx_pulses_restore(rf_rmt);
+    ESP_RETURN_ON_FALSE(pulse_count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid RF tri-state code");
+    rf_rmt->pulse_count = pulse_count;
+
+    return send_pulses(rf_rmt);
+}
+
+esp_err_t rf_send_trace(RFTransmitter* rf_rmt, const uint8_t* trace, size_t len) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && trace, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+    rf_rmt->saved = false;
+
+    const size_t pulse_count = rf_trace_to_pulses(trace, len, rf_rmt->pulses, RF_MAX_PULSES);
+    ESP_RETURN_ON_FALSE(pulse_count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid or oversized RF trace");
+    rf_rmt->pulse_count = pulse_count;
+
+    return rf_send(rf_rmt);
+}
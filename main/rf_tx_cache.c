@@ -0,0 +1,81 @@
+#include <string.h>
+#include "rf_common.h"
+#include "esp_check.h"
+#include "esp_log.h"
+
+esp_err_t rf_tx_cache_init(RFTxCache* rf_cache, RFPulse* arena, size_t arena_pulses) {
+    ESP_RETURN_ON_FALSE(rf_cache && arena && arena_pulses >= RF_MAX_PULSES, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code cache");
+    rf_cache_init(&rf_cache->cache, arena, arena_pulses);
+    portMUX_INITIALIZE(&rf_cache->lock);
+    return ESP_OK;
+}
+
+esp_err_t rf_tx_prepare(RFTxCache* rf_cache, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+        RFCacheHandle* handle) {
+    ESP_RETURN_ON_FALSE(rf_cache && code && handle, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code cache");
+    ESP_RETURN_ON_FALSE(proto_idx < rf_proto_count() && bit_length > 0 && (size_t)bit_length * 2 + 2 <= RF_MAX_PULSES,
+        ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+
+    // Only the lookup or reservation and the commit hold the lock, a new code is encoded into the arena in between
+    RFPulse* pulses;
+    const uint16_t count = (uint16_t)bit_length * 2 + 2;
+    portENTER_CRITICAL(&rf_cache->lock);
+    *handle = rf_cache_reserve(&rf_cache->cache, proto_idx, code, bit_length, count, &pulses);
+    portEXIT_CRITICAL(&rf_cache->lock);
+    ESP_RETURN_ON_FALSE(*handle, ESP_ERR_NO_MEM, TAG, "RF code cache is full of pinned codes");
+    if (!pulses) return ESP_OK;
+
+    // The code was validated above, so it encodes to exactly the reserved count
+    rf_encode_code(rf_proto_symbols(proto_idx), code, bit_length, pulses, count);
+    portENTER_CRITICAL(&rf_cache->lock);
+    rf_cache_commit(&rf_cache->cache, *handle);
+    portEXIT_CRITICAL(&rf_cache->lock);
+    return ESP_OK;
+}
+
+esp_err_t rf_tx_cache_pin(RFTxCache* rf_cache, RFCacheHandle handle, bool pin) {
+    ESP_RETURN_ON_FALSE(rf_cache, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code cache");
+
+    portENTER_CRITICAL(&rf_cache->lock);
+    const bool found = pin ? rf_cache_pin(&rf_cache->cache, handle) : rf_cache_unpin(&rf_cache->cache, handle);
+    portEXIT_CRITICAL(&rf_cache->lock);
+    ESP_RETURN_ON_FALSE(found, ESP_ERR_NOT_FOUND, TAG, "Prepared code was evicted");
+    return ESP_OK;
+}
+
+esp_err_t rf_tx_cache_get_stats(RFTxCache* rf_cache, RFCacheStats* stats) {
+    ESP_RETURN_ON_FALSE(rf_cache && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid RF code cache");
+
+    portENTER_CRITICAL(&rf_cache->lock);
+    *stats = rf_cache->cache.stats;
+    portEXIT_CRITICAL(&rf_cache->lock);
+    return ESP_OK;
+}
+
+esp_err_t rf_set_cache(RFTransmitter* rf_rmt, RFTxCache* rf_cache) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is active");
+
+    rf_rmt->tx_cache = rf_cache;
+    return ESP_OK;
+}
+
+esp_err_t rf_send_prepared(RFTransmitter* rf_rmt, RFCacheHandle handle) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && rf_rmt->tx_cache, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(!rf_rmt->tx_active, ESP_ERR_INVALID_STATE, TAG, "RF transmitter is already active");
+
+    // A copy, so the entry may be evicted while its pulses are on air
+    rf_tx_pulses_save(rf_rmt);
+    portENTER_CRITICAL(&rf_rmt->tx_cache->lock);
+    const RFCacheEntry* entry = rf_cache_get(&rf_rmt->tx_cache->cache, handle);
+    if (entry) {
+        memcpy(rf_rmt->pulses, rf_cache_pulses(&rf_rmt->tx_cache->cache, entry), entry->count * sizeof(RFPulse));
+        rf_rmt->pulse_count = entry->count;
+    }
+    portEXIT_CRITICAL(&rf_rmt->tx_cache->lock);
+    if (!entry) rf_tx_pulses_restore(rf_rmt);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Prepared code was evicted");
+
+    rf_rmt->tx_repeats = rf_rmt->repeat_count;
+    return rf_send_start(rf_rmt);
+}
@@ -0,0 +1,218 @@
+#include <string.h>
+#include "rf_common.h"
+#include "rf_metrics.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static inline bool same_command(const RFTxItem* item, uint8_t proto_idx, const RFCode* code, uint8_t bit_length) {
+    return item->proto_idx == proto_idx && item->bit_length == bit_length && rf_code_equal(&item->code, code);
+}
+
+// Highest priority first, oldest first among equals. Caller holds tx_lock
+static bool IRAM_ATTR queue_pop(RFTransmitter* rf_rmt, RFTxItem* out) {
+    if (!rf_rmt->tx_queue_count) return false;
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < rf_rmt->tx_queue_count; i++) {
+        const RFTxItem* item = &rf_rmt->tx_queue[i];
+        if (item->priority > rf_rmt->tx_queue[best].priority ||
+                (item->priority == rf_rmt->tx_queue[best].priority && (int32_t)(item->seq - rf_rmt->tx_queue[best].seq) < 0))
+            best = i;
+    }
+    *out = rf_rmt->tx_queue[best];
+    rf_rmt->tx_queue[best] = rf_rmt->tx_queue[--rf_rmt->tx_queue_count];
+    return true;
+}
+
+static void IRAM_ATTR cache_unpin(RFTransmitter* rf_rmt, RFCacheHandle handle) {
+    if (!handle || !rf_rmt->tx_cache) return;
+    portENTER_CRITICAL_SAFE(&rf_rmt->tx_cache->lock);
+    rf_cache_unpin(&rf_rmt->tx_cache->cache, handle);
+    portEXIT_CRITICAL_SAFE(&rf_rmt->tx_cache->lock);
+}
+
+// Encode or copy the current item into the pulse buffer, the timer is not reading it between items
+static bool IRAM_ATTR load_current(RFTransmitter* rf_rmt) {
+    const RFTxItem* item = &rf_rmt->tx_current;
+    size_t pulse_count = 0;
+    if (item->handle) {
+        // Pinned while queued, so the entry cannot have been evicted
+        portENTER_CRITICAL_SAFE(&rf_rmt->tx_cache->lock);
+        const RFCacheEntry* entry = rf_cache_get(&rf_rmt->tx_cache->cache, item->handle);
+        if (entry) {
+            pulse_count = entry->count;
+            memcpy(rf_rmt->pulses, rf_cache_pulses(&rf_rmt->tx_cache->cache, entry), pulse_count * sizeof(RFPulse));
+        }
+        portEXIT_CRITICAL_SAFE(&rf_rmt->tx_cache->lock);
+    } else {
+        pulse_count = rf_encode_code(item->table, &item->code, item->bit_length, rf_rmt->pulses, RF_MAX_PULSES);
+    }
+    if (!pulse_count) return false;
+    rf_rmt->pulse_count = pulse_count;
+    rf_rmt->tx_repeats = item->repeat;
+    return true;
+}
+
+bool IRAM_ATTR rf_tx_queue_advance(RFTransmitter* rf_rmt, uint32_t* gap_us) {
+    const RFTxItem done = rf_rmt->tx_current;
+    const bool had_item = rf_rmt->tx_current_valid;
+    if (had_item) *gap_us = done.gap_us;
+
+    portENTER_CRITICAL_ISR(&rf_rmt->tx_lock);
+    if (had_item) rf_rmt->tx_stats.completed++;
+    rf_rmt->tx_current_valid = queue_pop(rf_rmt, &rf_rmt->tx_current);
+    // Going idle under the lock, so an enqueue either sees the transmitter active or starts it itself
+    if (!rf_rmt->tx_current_valid) rf_rmt->tx_active = false;
+    portEXIT_CRITICAL_ISR(&rf_rmt->tx_lock);
+
+    if (had_item) {
+        cache_unpin(rf_rmt, done.handle);
+        if (done.callback) done.callback(done.id, ESP_OK, done.arg);
+    }
+    if (!rf_rmt->tx_current_valid) return false;
+    if (!had_item) *gap_us = RF_TX_DEFAULT_GAP_US;
+
+    // Items are validated when queued, encoding cannot fail here
+    load_current(rf_rmt);
+    rf_tx_schedule_load(rf_rmt);
+    rf_metrics_inc(RF_METRIC_TX_SENDS);
+    rf_rmt->tx_start = esp_timer_get_time() + *gap_us;
+    if (rf_rmt->tx_duplex && rf_rmt->rx) rf_tx_echo_begin(rf_rmt, *gap_us);
+    return true;
+}
+
+// Queue item, which takes over its pin when it is queued rather than absorbed or rejected
+static esp_err_t enqueue_item(RFTransmitter* rf_rmt, RFTxItem item, const RFTxOptions* options, uint32_t* id) {
+    const RFTxOptions defaults = { 0 };
+    if (!options) options = &defaults;
+    item.callback = options->callback;
+    item.arg = options->arg;
+    item.gap_us = options->gap_us ? options->gap_us : RF_TX_DEFAULT_GAP_US;
+    item.priority = options->priority;
+    item.repeat = options->repeat ? options->repeat : rf_rmt->repeat_count;
+
+    bool start = false, queued = false;
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&rf_rmt->tx_lock);
+    RFTxItem* pending = NULL;
+    for (uint8_t i = 0; i < rf_rmt->tx_queue_count && !pending; i++) {
+        RFTxItem* candidate = &rf_rmt->tx_queue[i];
+        if (same_command(candidate, item.proto_idx, &item.code, item.bit_length) &&
+                (!item.callback || !candidate->callback || (candidate->callback == item.callback && candidate->arg == item.arg)))
+            pending = candidate;
+    }
+
+    if (pending) {
+        if (item.priority > pending->priority) pending->priority = item.priority;
+        if (item.repeat > pending->repeat) pending->repeat = item.repeat;
+        if (!pending->callback) {
+            pending->callback = item.callback;
+            pending->arg = item.arg;
+        }
+        item.id = pending->id;
+        rf_rmt->tx_stats.coalesced++;
+    } else if (rf_rmt->tx_queue_count < RF_TX_QUEUE_SIZE) {
+        item.id = rf_rmt->tx_next_id++;
+        item.seq = rf_rmt->tx_seq++;
+        rf_rmt->tx_queue[rf_rmt->tx_queue_count++] = item;
+        if (rf_rmt->tx_queue_count > rf_rmt->tx_stats.max_depth) rf_rmt->tx_stats.max_depth = rf_rmt->tx_queue_count;
+        rf_rmt->tx_stats.enqueued++;
+        queued = true;
+    } else {
+        rf_rmt->tx_stats.rejected++;
+        err = ESP_ERR_NO_MEM;
+    }
+
+    // Idle transmitter: claim it here, from then on the timer ISR drains the queue
+    if (err == ESP_OK && !rf_rmt->tx_active) {
+        rf_rmt->tx_active = true;
+        rf_rmt->tx_current_valid = queue_pop(rf_rmt, &rf_rmt->tx_current);
+        start = true;
+    }
+    portEXIT_CRITICAL(&rf_rmt->tx_lock);
+    if (!queued) cache_unpin(rf_rmt, item.handle);
+    ESP_RETURN_ON_ERROR(err, TAG, "RF transmit queue is full");
+    if (id) *id = item.id;
+
+    if (start) {
+        rf_tx_pulses_save(rf_rmt);
+        load_current(rf_rmt);
+        err = rf_send_start(rf_rmt);
+        if (err != ESP_OK) {
+            /* The popped item, possibly queued by an earlier caller, completes with the error. The pulses
+            go back while the transmitter is still claimed, so another task cannot start in between */
+            const RFTxItem failed = rf_rmt->tx_current;
+            rf_tx_pulses_restore(rf_rmt);
+            portENTER_CRITICAL(&rf_rmt->tx_lock);
+            rf_rmt->tx_current_valid = false;
+            rf_rmt->tx_active = false;
+            portEXIT_CRITICAL(&rf_rmt->tx_lock);
+            cache_unpin(rf_rmt, failed.handle);
+            if (failed.callback) failed.callback(failed.id, err, failed.arg);
+        }
+    }
+    return err;
+}
+
+esp_err_t rf_tx_enqueue(RFTransmitter* rf_rmt, uint8_t proto_idx, const RFCode* code, uint8_t bit_length,
+        const RFTxOptions* options, uint32_t* id) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && code, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(rf_rmt->tx_backend == RF_TX_BACKEND_GPTIMER, ESP_ERR_NOT_SUPPORTED, TAG, "Transmit queue needs the GPTimer backend");
+    ESP_RETURN_ON_FALSE(proto_idx < rf_proto_count() && bit_length > 0 && (size_t)bit_length * 2 + 2 <= RF_MAX_PULSES,
+        ESP_ERR_INVALID_ARG, TAG, "Invalid RF code");
+
+    const RFTxItem item = {
+        .code = *code,
+        .table = rf_proto_symbols(proto_idx),
+        .bit_length = bit_length,
+        .proto_idx = proto_idx,
+    };
+    return enqueue_item(rf_rmt, item, options, id);
+}
+
+esp_err_t rf_tx_enqueue_prepared(RFTransmitter* rf_rmt, RFCacheHandle handle, const RFTxOptions* options, uint32_t* id) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && rf_rmt->tx_cache, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+    ESP_RETURN_ON_FALSE(rf_rmt->tx_backend == RF_TX_BACKEND_GPTIMER, ESP_ERR_NOT_SUPPORTED, TAG, "Transmit queue needs the GPTimer backend");
+
+    RFTxItem item = { .handle = handle };
+    portENTER_CRITICAL(&rf_rmt->tx_cache->lock);
+    const RFCacheEntry* entry = rf_cache_get(&rf_rmt->tx_cache->cache, handle);
+    if (entry) {
+        rf_cache_pin(&rf_rmt->tx_cache->cache, handle);
+        item.code = entry->code;
+        item.bit_length = entry->bit_length;
+        item.proto_idx = entry->proto_idx;
+    }
+    portEXIT_CRITICAL(&rf_rmt->tx_cache->lock);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Prepared code was evicted");
+
+    item.table = rf_proto_symbols(item.proto_idx);
+    return enqueue_item(rf_rmt, item, options, id);
+}
+
+esp_err_t rf_tx_flush(RFTransmitter* rf_rmt) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+
+    RFTxItem dropped[RF_TX_QUEUE_SIZE];
+    portENTER_CRITICAL(&rf_rmt->tx_lock);
+    const uint8_t count = rf_rmt->tx_queue_count;
+    memcpy(dropped, rf_rmt->tx_queue, count * sizeof(RFTxItem));
+    rf_rmt->tx_queue_count = 0;
+    portEXIT_CRITICAL(&rf_rmt->tx_lock);
+
+    for (uint8_t i = 0; i < count; i++) {
+        cache_unpin(rf_rmt, dropped[i].handle);
+        if (dropped[i].callback) dropped[i].callback(dropped[i].id, ESP_ERR_INVALID_STATE, dropped[i].arg);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rf_tx_get_stats(RFTransmitter* rf_rmt, RFTxQueueStats* stats) {
+    ESP_RETURN_ON_FALSE(rf_rmt && rf_rmt->init && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid RF transmitter");
+
+    portENTER_CRITICAL(&rf_rmt->tx_lock);
+    *stats = rf_rmt->tx_stats;
+    stats->depth = rf_rmt->tx_queue_count;
+    portEXIT_CRITICAL(&rf_rmt->tx_lock);
+    return ESP_OK;
+}